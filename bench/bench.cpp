@@ -0,0 +1,948 @@
+#include <cppargs.hpp>
+#include <enum_argument.hpp>
+#include <observer.hpp>
+#include <cache.hpp>
+#include <completion.hpp>
+#include <schema.hpp>
+#include <subcommands.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if __has_include(<sys/resource.h>)
+#include <sys/resource.h>
+#define CPPARGS_BENCH_HAS_RUSAGE
+#endif
+
+// Every benchmark prints one JSON object per line, so the output can be compared across
+// versions with ordinary tooling. Allocations are counted by replacing the global `operator new`.
+
+namespace {
+    std::atomic<std::size_t> allocation_count;
+} // namespace
+
+auto operator new(std::size_t const size) -> void*
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* const pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc {};
+}
+
+// `std::pmr::new_delete_resource` allocates through the aligned overloads
+auto operator new(std::size_t const size, std::align_val_t const alignment) -> void*
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    auto const align = static_cast<std::size_t>(alignment);
+    if (void* const pointer = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return pointer;
+    }
+    throw std::bad_alloc {};
+}
+
+auto operator delete(void* const pointer) noexcept -> void
+{
+    std::free(pointer);
+}
+
+auto operator delete(void* const pointer, std::size_t) noexcept -> void
+{
+    std::free(pointer);
+}
+
+auto operator delete(void* const pointer, std::align_val_t) noexcept -> void
+{
+    std::free(pointer);
+}
+
+auto operator delete(void* const pointer, std::size_t, std::align_val_t) noexcept -> void
+{
+    std::free(pointer);
+}
+
+namespace {
+    // Enumeration with as many names as a list of regions or instance types
+    enum class Region : std::uint16_t {};
+
+    constexpr std::size_t region_count = 400;
+
+    constexpr auto region_spellings = [] {
+        std::array<std::array<char, 16>, region_count> spellings {};
+        for (std::size_t index = 0; index != region_count; ++index) {
+            constexpr std::string_view prefixes[] { "north", "south", "east-", "west-" };
+            std::ranges::copy(prefixes[index % 4], spellings[index].begin());
+            std::ranges::copy(std::string_view("-zone-"), spellings[index].begin() + 5);
+            spellings[index][11] = static_cast<char>('0' + index / 100);
+            spellings[index][12] = static_cast<char>('0' + index / 10 % 10);
+            spellings[index][13] = static_cast<char>('0' + index % 10);
+        }
+        return spellings;
+    }();
+
+    constexpr auto region_names = [] {
+        cppargs::Enum_names<Region, region_count> names { .type_name = "region", .names = {} };
+        for (std::size_t index = 0; index != region_count; ++index) {
+            names.names[index] = {
+                .name  = std::string_view(region_spellings[index].data(), 14),
+                .value = static_cast<Region>(index),
+            };
+        }
+        return names;
+    }();
+} // namespace
+
+template <>
+struct cppargs::Argument<Region> : cppargs::Enum_argument<region_names> {};
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    enum class Mix { long_options, short_clusters, incremental, mixed };
+
+    [[nodiscard]] auto mix_name(Mix const mix) -> std::string_view
+    {
+        switch (mix) {
+        case Mix::long_options:
+            return "long";
+        case Mix::short_clusters:
+            return "short";
+        case Mix::incremental:
+            return "incremental";
+        case Mix::mixed:
+            return "mixed";
+        default:
+            std::abort();
+        }
+    }
+
+    [[nodiscard]] auto peak_rss_kib() -> long
+    {
+#ifdef CPPARGS_BENCH_HAS_RUSAGE
+        rusage usage {};
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+            return usage.ru_maxrss;
+        }
+#endif
+        return 0;
+    }
+
+    // Synthetic schema. Parameter kinds cycle through flag, int, incremental int, and string.
+    // The first 52 parameters also have a short name.
+    struct Schema {
+        std::vector<std::string>                                   names;
+        std::vector<char>                                          short_names;
+        std::vector<std::size_t>                                   flags;
+        std::vector<std::size_t>                                   options;
+        std::vector<std::size_t>                                   incrementals;
+        cppargs::Parameters                                        parameters;
+        std::vector<cppargs::Parameter<cppargs::Unit>>             flag_handles;
+        std::vector<cppargs::Parameter<int>>                       int_handles;
+        std::vector<cppargs::Parameter<cppargs::Incremental<int>>> incremental_handles;
+        std::vector<cppargs::Parameter<std::string>>               string_handles;
+
+        explicit Schema(std::size_t const size)
+        {
+            constexpr std::string_view letters
+                = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+            for (std::size_t index = 0; index != size; ++index) {
+                names.push_back(std::format("parameter-{}", index));
+                short_names.push_back(index < letters.size() ? letters[index] : '\0');
+            }
+            for (std::size_t index = 0; index != size; ++index) {
+                auto const short_name = short_names[index] == '\0'
+                                          ? std::nullopt
+                                          : std::optional<char>(short_names[index]);
+                switch (index % 4) {
+                case 0:
+                    flags.push_back(index);
+                    flag_handles.push_back(parameters.add(short_name, names[index]));
+                    break;
+                case 1:
+                    options.push_back(index);
+                    int_handles.push_back(parameters.add<int>(short_name, names[index]));
+                    break;
+                case 2:
+                    incrementals.push_back(index);
+                    incremental_handles.push_back(
+                        parameters.add<cppargs::Incremental<int>>(short_name, names[index]));
+                    break;
+                default:
+                    options.push_back(index);
+                    string_handles.push_back(
+                        parameters.add<std::string>(short_name, names[index], "Some string"));
+                }
+            }
+        }
+    };
+
+    // Command line of exactly `count` arguments, not counting the program name
+    struct Synthetic_command_line {
+        std::vector<std::string> tokens;
+        std::vector<char const*> pointers;
+
+        auto finalize() -> void
+        {
+            pointers.push_back("cppargs-bench");
+            for (auto const& token : tokens) {
+                pointers.push_back(token.c_str());
+            }
+        }
+    };
+
+    [[nodiscard]] auto make_command_line(
+        Schema const& schema, std::size_t const count, Mix const mix) -> Synthetic_command_line
+    {
+        Synthetic_command_line command_line;
+        command_line.tokens.reserve(count);
+
+        std::string cluster = "-";
+        for (std::size_t const index : schema.flags) {
+            if (schema.short_names[index] != '\0' && cluster.size() != 5) {
+                cluster.push_back(schema.short_names[index]);
+            }
+        }
+
+        auto const pick = [](std::vector<std::size_t> const& indices, std::size_t const n) {
+            return indices[(n * 7919) % indices.size()];
+        };
+
+        for (std::size_t n = 0; command_line.tokens.size() != count; ++n) {
+            auto const remaining = count - command_line.tokens.size();
+            auto const short_turn
+                = mix == Mix::short_clusters || (mix == Mix::mixed && n % 2 == 1);
+
+            if (short_turn && cluster.size() > 1) {
+                command_line.tokens.push_back(cluster);
+            }
+            else if (
+                remaining == 1 || mix == Mix::short_clusters
+                || (n % 3 == 0 && mix != Mix::incremental))
+            {
+                command_line.tokens.push_back("--" + schema.names[pick(schema.flags, n)]);
+            }
+            else {
+                auto const& indices
+                    = mix == Mix::incremental || schema.options.empty() ? schema.incrementals
+                                                                        : schema.options;
+                auto const index = pick(indices, n);
+                command_line.tokens.push_back("--" + schema.names[index]);
+                command_line.tokens.push_back(index % 4 == 3 ? "value" : "12345");
+            }
+        }
+
+        command_line.finalize();
+        return command_line;
+    }
+
+    struct Measurement {
+        std::chrono::nanoseconds time {};
+        std::size_t              allocations {};
+        std::size_t              repetitions {};
+    };
+
+    // Runs `body` against a fresh schema `repetitions` times, timing only `body`
+    template <class Body>
+    [[nodiscard]] auto measure(
+        std::size_t const parameters, std::size_t const repetitions, Body body) -> Measurement
+    {
+        Measurement measurement { .repetitions = repetitions };
+        for (std::size_t n = 0; n != repetitions; ++n) {
+            Schema     schema(parameters);
+            auto const allocations = allocation_count.load(std::memory_order_relaxed);
+            auto const start       = Clock::now();
+            body(schema);
+            measurement.time += Clock::now() - start;
+            measurement.allocations
+                += allocation_count.load(std::memory_order_relaxed) - allocations;
+        }
+        return measurement;
+    }
+
+    [[nodiscard]] auto repetitions_for(std::size_t const work) -> std::size_t
+    {
+        return std::clamp<std::size_t>(2'000'000 / (work + 1), 3, 200);
+    }
+
+    auto report(
+        std::string_view const benchmark,
+        std::size_t const      parameters,
+        std::size_t const      tokens,
+        std::string_view const mix,
+        Measurement const&     measurement) -> void
+    {
+        auto const repetitions = static_cast<double>(measurement.repetitions);
+        auto const nanoseconds = static_cast<double>(measurement.time.count()) / repetitions;
+        std::fputs(
+            std::format(
+                "{{\"benchmark\":\"{}\",\"parameters\":{},\"tokens\":{},\"mix\":\"{}\","
+                "\"ns_per_run\":{:.1f},\"ns_per_arg\":{:.2f},\"allocations_per_run\":{:.2f},"
+                "\"peak_rss_kib\":{}}}\n",
+                benchmark,
+                parameters,
+                tokens,
+                mix,
+                nanoseconds,
+                nanoseconds / static_cast<double>(std::max<std::size_t>(tokens, 1)),
+                static_cast<double>(measurement.allocations) / repetitions,
+                peak_rss_kib())
+                .c_str(),
+            stdout);
+        std::fflush(stdout);
+    }
+
+    auto bench_parse(std::size_t const parameters, std::size_t const tokens, Mix const mix) -> void
+    {
+        auto const command_line = make_command_line(Schema(parameters), tokens, mix);
+        auto const measurement  = measure(parameters, repetitions_for(tokens), [&](Schema& schema) {
+            cppargs::parse(command_line.pointers, schema.parameters);
+        });
+        report("parse", parameters, tokens, mix_name(mix), measurement);
+    }
+
+    // Parse with an observer that only keeps the totals
+    auto bench_observed(std::size_t const parameters, std::size_t const tokens, Mix const mix)
+        -> void
+    {
+        struct Totals : cppargs::Parse_observer {
+            cppargs::Parse_stats stats;
+
+            auto on_finish(cppargs::Parse_stats const& totals) -> void override
+            {
+                stats = totals;
+            }
+        };
+
+        auto const command_line = make_command_line(Schema(parameters), tokens, mix);
+        auto const measurement  = measure(parameters, repetitions_for(tokens), [&](Schema& schema) {
+            Totals totals;
+            cppargs::parse(command_line.pointers, schema.parameters, totals);
+        });
+        report("parse_observed", parameters, tokens, mix_name(mix), measurement);
+    }
+
+    auto bench_parallel(std::size_t const parameters, std::size_t const tokens, Mix const mix)
+        -> void
+    {
+        auto const command_line = make_command_line(Schema(parameters), tokens, mix);
+        auto const measurement  = measure(parameters, repetitions_for(tokens), [&](Schema& schema) {
+            cppargs::parse_parallel(command_line.pointers, schema.parameters);
+        });
+        report("parse_parallel", parameters, tokens, mix_name(mix), measurement);
+    }
+
+    auto bench_errors(std::size_t const parameters, std::size_t const tokens) -> void
+    {
+        auto command_line            = make_command_line(Schema(parameters), tokens, Mix::mixed);
+        command_line.tokens.back()   = "--not-a-parameter";
+        command_line.pointers.back() = command_line.tokens.back().c_str();
+
+        auto const repetitions = repetitions_for(tokens);
+
+        auto const lazy = measure(parameters, repetitions, [&](Schema& schema) {
+            (void)cppargs::try_parse(command_line.pointers, schema.parameters);
+        });
+        report("try_parse_error", parameters, tokens, "mixed", lazy);
+
+        auto const eager = measure(parameters, repetitions, [&](Schema& schema) {
+            try {
+                cppargs::parse(command_line.pointers, schema.parameters);
+            }
+            catch (cppargs::Exception const& exception) {
+                (void)exception.what();
+            }
+        });
+        report("exception_error", parameters, tokens, "mixed", eager);
+    }
+
+    auto bench_schema(std::size_t const parameters) -> void
+    {
+        Measurement measurement { .repetitions = repetitions_for(parameters * 10) };
+        for (std::size_t n = 0; n != measurement.repetitions; ++n) {
+            auto const   allocations = allocation_count.load(std::memory_order_relaxed);
+            auto const   start       = Clock::now();
+            Schema const schema(parameters);
+            measurement.time += Clock::now() - start;
+            measurement.allocations
+                += allocation_count.load(std::memory_order_relaxed) - allocations;
+        }
+        report("schema", parameters, parameters, "none", measurement);
+    }
+
+    auto bench_help(std::size_t const parameters) -> void
+    {
+        auto const repetitions = repetitions_for(parameters * 10);
+        auto const measurement = measure(parameters, repetitions, [](Schema& schema) {
+            (void)schema.parameters.help_string();
+        });
+        report("help_string", parameters, parameters, "none", measurement);
+
+        std::string buffer(Schema(parameters).parameters.help_string().size(), '\0');
+        auto const  streaming = measure(parameters, repetitions, [&](Schema& schema) {
+            (void)schema.parameters.help_to(buffer.data());
+        });
+        report("help_to", parameters, parameters, "none", streaming);
+    }
+
+    // Misspelled and abbreviated names, as typed in interactive tooling. The first lookup sorts
+    // the long names, later ones reuse them.
+    auto bench_suggest(std::size_t const parameters) -> void
+    {
+        auto const typo        = std::format("paramter-{}", parameters / 2);
+        auto const repetitions = repetitions_for(parameters * 10);
+        auto const first       = measure(parameters, repetitions, [&](Schema& schema) {
+            (void)schema.parameters.suggest(typo);
+        });
+        report("suggest_first", parameters, 1, "none", first);
+
+        Schema schema(parameters);
+        schema.parameters.allow_abbreviations();
+        (void)schema.parameters.suggest(typo);
+
+        auto const repeat = [&](std::string_view const benchmark, auto const body) {
+            Measurement measurement { .repetitions = repetitions_for(parameters) };
+            auto const  allocations = allocation_count.load(std::memory_order_relaxed);
+            auto const  start       = Clock::now();
+            for (std::size_t n = 0; n != measurement.repetitions; ++n) {
+                body();
+            }
+            measurement.time = Clock::now() - start;
+            measurement.allocations
+                = allocation_count.load(std::memory_order_relaxed) - allocations;
+            report(benchmark, parameters, 1, "none", measurement);
+        };
+        repeat("suggest", [&] { (void)schema.parameters.suggest(typo); });
+
+        // Every name starts with this, so the lookup is ambiguous.
+        repeat("abbreviation", [&] { (void)schema.parameters.match("param"); });
+    }
+
+    // Writes more than the private caches hold, so that the next run starts with a cold cache,
+    // as in a process that parses its command line once
+    auto evict_caches() -> void
+    {
+        static std::array<char, 16 << 20> buffer {};
+        static char                       fill {};
+        std::ranges::fill(buffer, ++fill);
+    }
+
+    // Lookups and scans of the parameter table, as done when matching options, with the table in
+    // cache and without. Names are looked up in a scattered order rather than in table order.
+    auto bench_lookup(std::size_t const parameters) -> void
+    {
+        Schema const schema(parameters);
+
+        std::size_t volatile          sink {}; // Keeps the results from being optimized away
+        std::vector<std::string_view> names;
+        for (std::size_t n = 0; n != parameters; ++n) {
+            names.push_back(schema.names[(n * 7919) % parameters]);
+        }
+
+        auto const repeat = [&](std::string_view const benchmark, auto const body) {
+            Measurement warm { .repetitions = repetitions_for(parameters) };
+            auto const  start = Clock::now();
+            for (std::size_t n = 0; n != warm.repetitions; ++n) {
+                body();
+            }
+            warm.time = Clock::now() - start;
+            report(benchmark, parameters, parameters, "none", warm);
+
+            Measurement cold { .repetitions = 20 };
+            for (std::size_t n = 0; n != cold.repetitions; ++n) {
+                evict_caches();
+                auto const begin = Clock::now();
+                body();
+                cold.time += Clock::now() - begin;
+            }
+            report(std::format("{}_cold", benchmark), parameters, parameters, "none", cold);
+        };
+        repeat("lookup", [&] {
+            std::size_t flags = 0;
+            for (auto const name : names) {
+                flags += schema.parameters.find(name)->is_flag;
+            }
+            sink = flags;
+        });
+        repeat("scan", [&] {
+            std::size_t matches = 0;
+            for (auto const& info : schema.parameters.info_span()) {
+                matches += !info.is_flag && info.short_name.has_value();
+            }
+            sink = matches;
+        });
+    }
+
+    // A completion query, as answered by a freshly started program
+    auto bench_completion(std::size_t const parameters) -> void
+    {
+        auto const        prefix = std::format("--parameter-{}", parameters / 2);
+        char const* const command_line[] { "prog", prefix.c_str() };
+
+        auto const repetitions = repetitions_for(parameters * 10);
+        auto const options     = measure(parameters, repetitions, [&](Schema& schema) {
+            (void)cppargs::complete(command_line, 1, schema.parameters);
+        });
+        report("complete_option", parameters, 1, "none", options);
+    }
+
+    // Environment of `variables` entries, one in ten of which sets a parameter
+    auto bench_environment(std::size_t const parameters, std::size_t const variables) -> void
+    {
+        std::vector<std::string> strings;
+        for (std::size_t n = 0; n != variables; ++n) {
+            strings.push_back(
+                n % 10 == 0 ? std::format("BENCH_PARAMETER_{}=1", (n / 10) % parameters)
+                            : std::format("UNRELATED_VARIABLE_{}=/some/value", n));
+        }
+        std::vector<char const*> environment;
+        for (auto const& string : strings) {
+            environment.push_back(string.c_str());
+        }
+
+        auto const repetitions = repetitions_for(variables);
+        auto const measurement = measure(parameters, repetitions, [&](Schema& schema) {
+            schema.parameters.set_environment_prefix("BENCH_");
+            cppargs::parse_environment(environment, schema.parameters);
+        });
+        report("environment", parameters, variables, "none", measurement);
+    }
+
+    // Dispatch to one of `count` subcommands of `options` options each, with the parameters built
+    // lazily against building the parameters of every subcommand up front
+    auto bench_subcommands(std::size_t const count, std::size_t const options) -> void
+    {
+        std::vector<std::string> names;
+        std::vector<std::string> option_names;
+        for (std::size_t n = 0; n != count; ++n) {
+            names.push_back(std::format("command-{}", n));
+        }
+        for (std::size_t n = 0; n != options; ++n) {
+            option_names.push_back(std::format("option-{}", n));
+        }
+        auto const build = [&](cppargs::Parameters& parameters) {
+            for (auto const& name : option_names) {
+                (void)parameters.add<int>(name);
+            }
+        };
+
+        Synthetic_command_line command_line;
+        command_line.tokens.push_back(names[count / 2]);
+        for (std::size_t n = 0; n != 4; ++n) {
+            command_line.tokens.push_back("--" + option_names[(n * 7) % options]);
+            command_line.tokens.push_back("12345");
+        }
+        command_line.finalize();
+
+        auto const repetitions = repetitions_for(count * options);
+
+        auto const lazy = measure(0, repetitions, [&](Schema&) {
+            cppargs::Subcommands subcommands;
+            for (auto const& name : names) {
+                subcommands.add(name, {}, build);
+            }
+            subcommands.parse(command_line.pointers);
+        });
+        report("subcommands", count * options, command_line.tokens.size(), "int", lazy);
+
+        auto const eager = measure(0, repetitions, [&](Schema&) {
+            auto const all = std::make_unique<cppargs::Parameters[]>(count);
+            for (std::size_t index = 0; index != count; ++index) {
+                build(all[index]);
+            }
+            auto const selected = std::ranges::find(names, command_line.tokens.front());
+            auto const index    = static_cast<std::size_t>(selected - names.begin());
+            cppargs::parse(cppargs::Command_line(command_line.pointers).subspan(1), all[index]);
+        });
+        report("subcommands_eager", count * options, command_line.tokens.size(), "int", eager);
+    }
+
+    // Paths taken by a variadic positional parameter against the same paths passed as
+    // `Incremental<std::string>` option values
+    auto bench_positional(std::size_t const count) -> void
+    {
+        Synthetic_command_line positional;
+        Synthetic_command_line options;
+        for (std::size_t n = 0; n != count; ++n) {
+            auto path = std::format("/usr/local/share/cppargs/input-{}.txt", n);
+            options.tokens.push_back("--path");
+            options.tokens.push_back(path);
+            positional.tokens.push_back(std::move(path));
+        }
+        positional.finalize();
+        options.finalize();
+
+        auto const repetitions = repetitions_for(count);
+
+        auto const positional_measurement = measure(0, repetitions, [&](Schema&) {
+            cppargs::Parameters parameters;
+            auto const          paths
+                = parameters.add_positional<cppargs::Incremental<std::string_view>>("paths");
+            cppargs::parse(positional.pointers, parameters);
+        });
+        report("positional", 1, count, "path", positional_measurement);
+
+        auto const option_measurement = measure(0, repetitions, [&](Schema&) {
+            cppargs::Parameters parameters;
+            auto const paths = parameters.add<cppargs::Incremental<std::string>>("path");
+            cppargs::parse(options.pointers, parameters);
+        });
+        report("positional_option", 1, count, "path", option_measurement);
+    }
+
+    // Paths passed to a sink parameter, against the same paths stored by
+    // `Incremental<std::string>`. The sink runs first, so that its peak RSS is not raised by the
+    // stored paths.
+    auto bench_sink(std::size_t const count) -> void
+    {
+        Synthetic_command_line command_line;
+        for (std::size_t n = 0; n != count; ++n) {
+            command_line.tokens.push_back("--input");
+            command_line.tokens.push_back(
+                std::format("/usr/local/share/cppargs/input-{}.txt", n));
+        }
+        command_line.finalize();
+
+        auto const repetitions = repetitions_for(count);
+
+        std::size_t volatile sink {};
+        auto const           sink_measurement = measure(0, repetitions, [&](Schema&) {
+            cppargs::Parameters parameters;
+            std::size_t         bytes  = 0;
+            auto const          inputs = parameters.add_sink<std::string>(
+                "input", "Input file", [&](std::string const path) { bytes += path.size(); });
+            cppargs::parse(command_line.pointers, parameters);
+            sink = bytes;
+        });
+        report("sink", 1, count, "path", sink_measurement);
+
+        auto const incremental_measurement = measure(0, repetitions, [&](Schema&) {
+            cppargs::Parameters parameters;
+            auto const inputs = parameters.add<cppargs::Incremental<std::string>>("input");
+            cppargs::parse(command_line.pointers, parameters);
+        });
+        report("sink_incremental", 1, count, "path", incremental_measurement);
+    }
+
+    // The same command line parsed normally and restored from a `cppargs::Parse_cache` snapshot
+    auto bench_cache(std::size_t const parameters, std::size_t const tokens) -> void
+    {
+        auto const command_line = make_command_line(Schema(parameters), tokens, Mix::mixed);
+        auto const directory = std::filesystem::temp_directory_path() / "cppargs-bench-cache";
+        std::filesystem::remove_all(directory);
+
+        auto const repetitions = repetitions_for(tokens);
+        auto const uncached    = measure(parameters, repetitions, [&](Schema& schema) {
+            cppargs::Response_files files;
+            cppargs::parse(command_line.pointers, schema.parameters, files);
+        });
+        report("cache_miss_baseline", parameters, tokens, "mixed", uncached);
+
+        cppargs::Parse_cache cache(directory.string());
+        {
+            Schema                  schema(parameters);
+            cppargs::Response_files files;
+            cppargs::parse(command_line.pointers, schema.parameters, files, cache);
+        }
+        auto const cached = measure(parameters, repetitions, [&](Schema& schema) {
+            cppargs::Response_files files;
+            cppargs::parse(command_line.pointers, schema.parameters, files, cache);
+        });
+        if (cache.hits() != repetitions) {
+            throw std::runtime_error("Parse cache snapshot was not used");
+        }
+        report("cache_hit", parameters, tokens, "mixed", cached);
+        std::filesystem::remove_all(directory);
+    }
+
+    // Generated config file of roughly `bytes` bytes, mapped once and applied on every run.
+    // Keys cycle through the incremental parameters of the schema, within a section.
+    auto bench_config(std::size_t const parameters, std::size_t const bytes) -> void
+    {
+        auto const incrementals = Schema(parameters).incrementals;
+
+        std::string text = "# Generated by cppargs-bench\n[parameter]\n";
+        text.reserve(bytes + 64);
+        std::size_t lines = 0;
+        for (; text.size() < bytes; ++lines) {
+            text += std::format(
+                "{} = {}\n", incrementals[lines % incrementals.size()], (lines * 7919) % 100'000);
+        }
+
+        auto const path = (std::filesystem::temp_directory_path() / "cppargs-bench.conf").string();
+        if (auto const file = std::fopen(path.c_str(), "wb")) {
+            std::fwrite(text.data(), 1, text.size(), file);
+            std::fclose(file);
+        }
+        cppargs::Response_files files;
+        auto const              file = files.open(path);
+        if (file == nullptr) {
+            throw std::runtime_error(std::format("Could not read {}", path));
+        }
+
+        auto const measurement = measure(parameters, repetitions_for(lines), [&](Schema& schema) {
+            cppargs::parse_config(*file, schema.parameters);
+        });
+        report("config", parameters, lines, "incremental", measurement);
+        std::filesystem::remove(path);
+    }
+
+    // One `List<int>` argument against the same values passed as `Incremental<int>` pairs
+    auto bench_list(std::size_t const count) -> void
+    {
+        std::string list;
+        for (std::size_t n = 0; n != count; ++n) {
+            list += std::format("{},", (n * 7919) % 100'000'000);
+        }
+        list.pop_back();
+
+        Synthetic_command_line incremental;
+        for (std::size_t n = 0; n != count; ++n) {
+            incremental.tokens.push_back("--id");
+            incremental.tokens.push_back(std::format("{}", (n * 7919) % 100'000'000));
+        }
+        incremental.finalize();
+
+        char const* const list_command_line[] { "cppargs-bench", "--ids", list.c_str() };
+        auto const        repetitions = repetitions_for(count);
+
+        auto const list_measurement = measure(0, repetitions, [&](Schema&) {
+            cppargs::Parameters parameters;
+            auto const          ids = parameters.add<cppargs::List<int>>("ids");
+            cppargs::parse(list_command_line, parameters);
+        });
+        report("list", 1, count, "int", list_measurement);
+
+        auto const incremental_measurement = measure(0, repetitions, [&](Schema&) {
+            cppargs::Parameters parameters;
+            auto const          ids = parameters.add<cppargs::Incremental<int>>("id");
+            cppargs::parse(incremental.pointers, parameters);
+        });
+        report("list_incremental", 1, count, "int", incremental_measurement);
+    }
+
+    // Enumeration names looked up with the perfect hash of `Enum_argument`, against the chain of
+    // comparisons it replaces
+    auto bench_enum(std::size_t const count) -> void
+    {
+        std::vector<std::string> tokens;
+        for (std::size_t n = 0; n != count; ++n) {
+            tokens.emplace_back(region_names.names[(n * 7919) % region_count].name);
+        }
+
+        std::size_t volatile sink {};
+        auto const           run = [&](std::string_view const benchmark, auto const parse) {
+            Measurement measurement { .repetitions = repetitions_for(count) };
+            auto const  start = Clock::now();
+            for (std::size_t n = 0; n != measurement.repetitions; ++n) {
+                std::size_t sum = 0;
+                for (auto const& token : tokens) {
+                    sum += static_cast<std::size_t>(parse(token).value());
+                }
+                sink = sum;
+            }
+            measurement.time = Clock::now() - start;
+            report(benchmark, region_count, count, "names", measurement);
+        };
+        run("enum_perfect_hash", cppargs::Argument<Region>::parse);
+        run("enum_comparisons", [](std::string_view const view) -> std::optional<Region> {
+            for (auto const& [name, value] : region_names.names) {
+                if (view == name) {
+                    return value;
+                }
+            }
+            return std::nullopt;
+        });
+    }
+
+    // Shell-like command string of roughly `bytes` bytes. Every fourth argument is quoted.
+    [[nodiscard]] auto make_command_string(std::size_t const bytes) -> std::string
+    {
+        std::string string;
+        string.reserve(bytes + 64);
+        for (std::size_t n = 0; string.size() < bytes; ++n) {
+            switch (n % 4) {
+            case 0:
+                string += std::format("--parameter-{} ", n % 1000);
+                break;
+            case 1:
+                string += std::format("/usr/local/share/cppargs/input-{}.txt ", n);
+                break;
+            case 2:
+                string += std::format("{} ", n * 7919);
+                break;
+            default:
+                string += std::format("'quoted value {}' ", n);
+            }
+        }
+        return string;
+    }
+
+    // What callers did before `cppargs::Command_string`: split on whitespace into owned strings
+    [[nodiscard]] auto naive_split(std::string const& string) -> Synthetic_command_line
+    {
+        Synthetic_command_line command_line;
+        std::istringstream     stream(string);
+        for (std::string token; stream >> token;) {
+            command_line.tokens.push_back(std::move(token));
+        }
+        command_line.finalize();
+        return command_line;
+    }
+
+    auto bench_tokenize(std::size_t const bytes) -> void
+    {
+        auto const string      = make_command_string(bytes);
+        auto const tokens      = cppargs::Command_string(string).arguments().size();
+        auto const repetitions = std::clamp<std::size_t>(200'000'000 / (bytes + 1), 3, 200);
+
+        auto const run = [&](auto const body) {
+            Measurement measurement { .repetitions = repetitions };
+            for (std::size_t n = 0; n != repetitions; ++n) {
+                auto const allocations = allocation_count.load(std::memory_order_relaxed);
+                auto const start       = Clock::now();
+                body();
+                measurement.time += Clock::now() - start;
+                measurement.allocations
+                    += allocation_count.load(std::memory_order_relaxed) - allocations;
+            }
+            return measurement;
+        };
+
+        report("tokenize", 0, tokens, "shell", run([&] {
+                   cppargs::Command_string const command_string(string);
+                   (void)command_string.arguments();
+               }));
+        report("tokenize_naive", 0, tokens, "shell", run([&] { (void)naive_split(string); }));
+    }
+} // namespace
+
+auto main(int const argc, char const* const* const argv) -> int
+{
+    try {
+        cppargs::Parameters parameters;
+
+        auto const help_flag   = parameters.add('h', "help", "Show this help text");
+        auto const quick_flag  = parameters.add('q', "quick", "Skip the largest command lines");
+        auto const filter_name = parameters.add<std::string>(
+            'f', "filter", "Only run benchmarks whose name contains the given string");
+
+        cppargs::parse(argc, argv, parameters);
+
+        if (help_flag) {
+            std::fputs(std::format("Options:\n{}", parameters.help_string()).c_str(), stdout);
+            return EXIT_SUCCESS;
+        }
+
+        auto const enabled = [&](std::string_view const name) {
+            return !filter_name || name.find(filter_name.value()) != std::string_view::npos;
+        };
+
+        constexpr std::size_t parameter_counts[] { 10, 100, 1000, 5000 };
+        constexpr std::size_t token_counts[] { 1, 100, 10'000, 1'000'000 };
+        constexpr Mix         mixes[] {
+            Mix::long_options,
+            Mix::short_clusters,
+            Mix::incremental,
+            Mix::mixed,
+        };
+
+        if (enabled("list")) {
+            bench_list(10'000);
+            if (!quick_flag) {
+                bench_list(1'000'000);
+            }
+        }
+        if (enabled("subcommands")) {
+            bench_subcommands(120, 30);
+        }
+        if (enabled("positional")) {
+            bench_positional(10'000);
+            if (!quick_flag) {
+                bench_positional(1'000'000);
+            }
+        }
+        if (enabled("sink")) {
+            bench_sink(10'000);
+            if (!quick_flag) {
+                bench_sink(1'000'000);
+            }
+        }
+        if (enabled("cache")) {
+            bench_cache(100, 10'000);
+            if (!quick_flag) {
+                bench_cache(100, 1'000'000);
+            }
+        }
+        if (enabled("config")) {
+            bench_config(100, 1 << 20);
+            if (!quick_flag) {
+                bench_config(100, 32 << 20);
+            }
+        }
+        if (enabled("enum")) {
+            bench_enum(10'000);
+        }
+        if (enabled("tokenize")) {
+            bench_tokenize(1 << 20);
+            if (!quick_flag) {
+                bench_tokenize(16 << 20);
+            }
+        }
+
+        for (std::size_t const parameter_count : parameter_counts) {
+            if (enabled("schema")) {
+                bench_schema(parameter_count);
+            }
+            if (enabled("help_string")) {
+                bench_help(parameter_count);
+            }
+            if (enabled("environment")) {
+                bench_environment(parameter_count, 5000);
+            }
+            if (enabled("complete")) {
+                bench_completion(parameter_count);
+            }
+            if (enabled("lookup") || enabled("scan")) {
+                bench_lookup(parameter_count);
+            }
+            if (enabled("suggest") || enabled("abbreviation")) {
+                bench_suggest(parameter_count);
+            }
+            for (std::size_t const token_count : token_counts) {
+                if (quick_flag && token_count > 10'000) {
+                    continue;
+                }
+                if (enabled("parse")) {
+                    for (Mix const mix : mixes) {
+                        bench_parse(parameter_count, token_count, mix);
+                    }
+                }
+                if (enabled("observed")) {
+                    bench_observed(parameter_count, token_count, Mix::mixed);
+                }
+                if (enabled("parallel") && token_count >= 10'000) {
+                    bench_parallel(parameter_count, token_count, Mix::incremental);
+                    bench_parallel(parameter_count, token_count, Mix::mixed);
+                }
+                if (enabled("error")) {
+                    bench_errors(parameter_count, token_count);
+                }
+            }
+        }
+    }
+    catch (std::exception const& exception) {
+        std::fputs(std::format("Error: {}\n", exception.what()).c_str(), stderr);
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,87 @@
+# Compile time and size of build_tool.cpp when cppargs is used through the header, with and without
+# the explicit instantiations of the library, and through the module if MODULE is set. Run in
+# script mode by the cppargs-build-bench target. Prints one JSON object per line, like
+# cppargs-bench. Supports GCC and Clang.
+
+cmake_minimum_required(VERSION 3.24)
+
+if (NOT DEFINED RUNS)
+    set(RUNS 5)
+endif ()
+if (NOT CXX_ID MATCHES "GNU|Clang")
+    message(FATAL_ERROR "build_bench.cmake does not support the ${CXX_ID} compiler")
+endif ()
+
+set(tool ${SOURCE_DIR}/bench/build_tool.cpp)
+set(interface ${SOURCE_DIR}/cppargs/cppargs.cppm)
+set(common -std=c++20 -O2 -I${SOURCE_DIR}/cppargs ${FLAGS})
+file(MAKE_DIRECTORY ${BINARY_DIR})
+
+# Unused instantiations are left out of the binaries.
+if (CMAKE_HOST_APPLE)
+    set(link -pthread -Wl,-dead_strip)
+else ()
+    set(link -pthread -Wl,--gc-sections)
+endif ()
+
+function(run)
+    execute_process(COMMAND ${ARGN} WORKING_DIRECTORY ${BINARY_DIR} RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "Command failed: ${ARGN}")
+    endif ()
+endfunction ()
+
+# Sets `out_microseconds` to the time of the fastest of `RUNS` runs of the command
+function(time_command out_microseconds)
+    set(best "")
+    foreach (attempt RANGE 1 ${RUNS})
+        string(TIMESTAMP start "%s%f" UTC)
+        run(${ARGN})
+        string(TIMESTAMP stop "%s%f" UTC)
+        math(EXPR elapsed "${stop} - ${start}")
+        if (best STREQUAL "" OR elapsed LESS best)
+            set(best ${elapsed})
+        endif ()
+    endforeach ()
+    set(${out_microseconds} ${best} PARENT_SCOPE)
+endfunction ()
+
+# `binary` may be empty for objects that are not linked on their own
+function(report benchmark microseconds object binary)
+    file(SIZE ${BINARY_DIR}/${object} object_bytes)
+    set(binary_bytes 0)
+    if (NOT binary STREQUAL "")
+        file(SIZE ${BINARY_DIR}/${binary} binary_bytes)
+    endif ()
+    math(EXPR milliseconds "${microseconds} / 1000")
+    string(CONCAT line
+        "{\"benchmark\":\"${benchmark}\",\"compile_ms\":${milliseconds},"
+        "\"object_bytes\":${object_bytes},\"binary_bytes\":${binary_bytes}}")
+    execute_process(COMMAND ${CMAKE_COMMAND} -E echo ${line})
+endfunction ()
+
+time_command(header ${CXX} ${common} -DCPPARGS_NO_EXTERN_TEMPLATES -c ${tool} -o header.o)
+run(${CXX} header.o ${LIBRARY} ${link} -o header)
+report(build_header ${header} header.o header)
+
+time_command(instantiated ${CXX} ${common} -c ${tool} -o instantiated.o)
+run(${CXX} instantiated.o ${LIBRARY} ${link} -o instantiated)
+report(build_header_instantiated ${instantiated} instantiated.o instantiated)
+
+if (MODULE)
+    if (CXX_ID STREQUAL "GNU")
+        set(import -fmodules-ts)
+        time_command(precompile
+            ${CXX} ${common} -fmodules-ts -x c++ -c ${interface} -o interface.o)
+    else ()
+        set(import -fmodule-file=cppargs=${BINARY_DIR}/cppargs.pcm)
+        time_command(precompile
+            ${CXX} ${common} -x c++-module --precompile ${interface} -o cppargs.pcm)
+        run(${CXX} -c cppargs.pcm -o interface.o)
+    endif ()
+    report(build_module_interface ${precompile} interface.o "")
+
+    time_command(module ${CXX} ${common} ${import} -DCPPARGS_BENCH_IMPORT -c ${tool} -o module.o)
+    run(${CXX} module.o interface.o ${LIBRARY} ${link} -o module)
+    report(build_module ${module} module.o module)
+endif ()
@@ -0,0 +1,66 @@
+// A typical command line tool, compiled by build_bench.cmake through the header and through the
+// module to compare compile time and binary size.
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <string_view>
+
+#ifdef CPPARGS_BENCH_IMPORT
+import cppargs;
+#else
+#include <cppargs.hpp>
+#endif
+
+auto main(int const argc, char const* const* const argv) -> int
+{
+    try {
+        cppargs::Parameters parameters;
+
+        auto const help    = parameters.add('h', "help", "Show this help text");
+        auto const verbose = parameters.add<cppargs::Incremental<cppargs::Unit>>('v', "verbose");
+        auto const quiet   = parameters.add('q', "quiet", "Only print errors");
+        auto const color   = parameters.add<bool>("color", "Colorize the output");
+        auto const jobs    = parameters.add<int>('j', "jobs", "Number of parallel jobs");
+        auto const limit   = parameters.add<long long>("limit", "Maximum number of results");
+        auto const port    = parameters.add<unsigned short>('p', "port", "Port to listen on");
+        auto const seed    = parameters.add<unsigned long>("seed", "Random seed");
+        auto const level   = parameters.add<char>('O', "level", "Optimization level");
+        auto const output  = parameters.add<std::string>('o', "output", "Output file");
+        auto const config  = parameters.add<std::string_view>('c', "config", "Config file");
+        auto const include = parameters.add<cppargs::Incremental<std::string>>('I', "include");
+        auto const define  = parameters.add<cppargs::Incremental<std::string_view>>('D', "define");
+        auto const ids     = parameters.add<cppargs::Incremental<int>>("id", "Identifiers");
+        auto const input   = parameters.add_positional<std::string_view>("input", "Input file");
+
+        cppargs::parse(argc, argv, parameters);
+
+        if (help) {
+            std::fputs(parameters.help_string().c_str(), stdout);
+            return EXIT_SUCCESS;
+        }
+        std::printf(
+            "%zu %d %d %d %lld %d %lu %c %s %.*s %zu %zu %zu %.*s\n",
+            verbose.values().size(),
+            static_cast<int>(quiet.has_value()),
+            static_cast<int>(color && color.value()),
+            jobs ? jobs.value() : 1,
+            limit ? limit.value() : -1,
+            port ? port.value() : 0,
+            seed ? seed.value() : 0,
+            level ? level.value() : '0',
+            output ? output.value().c_str() : "-",
+            config ? static_cast<int>(config.value().size()) : 0,
+            config ? config.value().data() : "",
+            include.values().size(),
+            define.values().size(),
+            ids.values().size(),
+            static_cast<int>(input.value().size()),
+            input.value().data());
+    }
+    catch (std::exception const& exception) {
+        std::fprintf(stderr, "Error: %s\n", exception.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cppargs {
+
+    // Queue of at most `capacity` values, for handing the values of a sink parameter to another
+    // thread while parsing continues. `push` waits while the queue is full, and `pop` while it is
+    // empty, so memory stays bounded however many values there are. Call `close` once parsing
+    // ends, also when it fails, so that the consumer stops waiting.
+    //
+    //     cppargs::Bounded_queue<std::string> queue(1024);
+    //     auto const inputs = parameters.add_sink<std::string>(
+    //         "input", "Input file", [&](std::string path) { queue.push(std::move(path)); });
+    //     std::jthread worker([&] {
+    //         while (auto path = queue.pop()) {
+    //             process(*path);
+    //         }
+    //     });
+    //     try {
+    //         cppargs::parse(argc, argv, parameters);
+    //     }
+    //     catch (...) {
+    //         queue.close();
+    //         throw;
+    //     }
+    //     queue.close();
+    template <class T>
+    class Bounded_queue {
+        std::mutex                    m_mutex;
+        std::condition_variable       m_not_full;
+        std::condition_variable       m_not_empty;
+        std::vector<std::optional<T>> m_ring;
+        std::size_t                   m_front {};
+        std::size_t                   m_size {};
+        bool                          m_closed {};
+    public:
+        // Throws `std::invalid_argument` if `capacity` is zero
+        explicit Bounded_queue(std::size_t const capacity) : m_ring(capacity)
+        {
+            if (capacity == 0) {
+                throw std::invalid_argument { "cppargs::Bounded_queue: Zero capacity" };
+            }
+        }
+
+        Bounded_queue(Bounded_queue const&)                    = delete;
+        auto operator=(Bounded_queue const&) -> Bounded_queue& = delete;
+
+        // Waits for room unless the queue is closed, in which case `value` is dropped and the
+        // result is false.
+        auto push(T value) -> bool
+        {
+            std::unique_lock lock(m_mutex);
+            m_not_full.wait(lock, [&] { return m_closed || m_size != m_ring.size(); });
+            if (m_closed) {
+                return false;
+            }
+            m_ring[(m_front + m_size++) % m_ring.size()].emplace(std::move(value));
+            lock.unlock();
+            m_not_empty.notify_one();
+            return true;
+        }
+
+        // The oldest value, after waiting for one. Nothing once the queue is closed and empty.
+        [[nodiscard]] auto pop() -> std::optional<T>
+        {
+            std::unique_lock lock(m_mutex);
+            m_not_empty.wait(lock, [&] { return m_closed || m_size != 0; });
+            if (m_size == 0) {
+                return std::nullopt;
+            }
+            std::optional<T> value = std::move(m_ring[m_front]);
+            m_ring[m_front].reset();
+            m_front = (m_front + 1) % m_ring.size();
+            --m_size;
+            lock.unlock();
+            m_not_full.notify_one();
+            return value;
+        }
+
+        // Values already in the queue can still be popped.
+        auto close() -> void
+        {
+            {
+                std::lock_guard const lock(m_mutex);
+                m_closed = true;
+            }
+            m_not_full.notify_all();
+            m_not_empty.notify_all();
+        }
+    };
+
+} // namespace cppargs
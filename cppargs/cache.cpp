@@ -0,0 +1,529 @@
+#include <cppargs.hpp>
+#include <cache.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <atomic>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    // The last byte is the version of the snapshot format
+    constexpr std::string_view magic { "cppargs\x02", 8 };
+
+    // Hashes 32 bytes at a time in four independent lanes, so that multi-megabyte command lines
+    // and response files are hashed at close to memory bandwidth
+    class Hasher {
+        static constexpr std::uint64_t prime = 0x9e37'79b9'7f4a'7c15;
+
+        using Lanes = std::array<std::uint64_t, 4>;
+
+        Lanes                m_lanes { 1, 2, 3, 4 };
+        std::array<char, 32> m_buffer {};
+        std::size_t          m_buffered {};
+        std::uint64_t        m_total {};
+
+        static auto absorb(Lanes& lanes, char const* const block) noexcept -> void
+        {
+            for (std::size_t lane = 0; lane != lanes.size(); ++lane) {
+                std::uint64_t word {};
+                std::memcpy(&word, block + (lane * sizeof word), sizeof word);
+                lanes[lane] = std::rotl((lanes[lane] ^ word) * prime, 31);
+            }
+        }
+    public:
+        auto add(std::string_view bytes) noexcept -> void
+        {
+            m_total += bytes.size();
+            if (m_buffered != 0) {
+                auto const count = std::min(m_buffer.size() - m_buffered, bytes.size());
+                std::memcpy(m_buffer.data() + m_buffered, bytes.data(), count);
+                m_buffered += count;
+                bytes.remove_prefix(count);
+                if (m_buffered != m_buffer.size()) {
+                    return;
+                }
+                absorb(m_lanes, m_buffer.data());
+                m_buffered = 0;
+            }
+            for (; bytes.size() >= m_buffer.size(); bytes.remove_prefix(m_buffer.size())) {
+                absorb(m_lanes, bytes.data());
+            }
+            if (!bytes.empty()) {
+                std::memcpy(m_buffer.data(), bytes.data(), bytes.size());
+                m_buffered = bytes.size();
+            }
+        }
+
+        template <class T>
+        auto add_value(T const value) noexcept -> void
+        {
+            add(std::string_view(reinterpret_cast<char const*>(&value), sizeof value));
+        }
+
+        // Prefixed by the size, so that consecutive strings cannot run into each other
+        auto add_string(std::string_view const string) noexcept -> void
+        {
+            add_value(static_cast<std::uint64_t>(string.size()));
+            add(string);
+        }
+
+        [[nodiscard]] auto finish() const noexcept -> std::uint64_t
+        {
+            auto lanes = m_lanes;
+            if (m_buffered != 0) {
+                std::array<char, 32> block {};
+                std::memcpy(block.data(), m_buffer.data(), m_buffered);
+                absorb(lanes, block.data());
+            }
+            std::uint64_t hash = m_total * prime;
+            for (auto const lane : lanes) {
+                hash = std::rotl(hash ^ (lane * prime), 27) * prime;
+            }
+            hash ^= hash >> 33;
+            hash *= 0xff51'afd7'ed55'8ccd;
+            hash ^= hash >> 33;
+            return hash;
+        }
+    };
+
+    [[nodiscard]] auto hash_bytes(std::string_view const bytes) noexcept -> std::uint64_t
+    {
+        Hasher hasher;
+        hasher.add(bytes);
+        return hasher.finish();
+    }
+
+    // Named parameters first, then positional ones
+    template <class F>
+    auto for_each_info(cppargs::Parameters const& parameters, F const& f) -> void
+    {
+        for (auto const& info : parameters.info_span()) {
+            f(info);
+        }
+        for (auto const& info : parameters.positional_parameters().infos) {
+            f(info);
+        }
+    }
+
+    // The arguments after the program name, each followed by a null character, so that they
+    // are hashed and compared as one block. The program name is left out since it is not
+    // parsed. The arguments of a process are laid out this way already, and are only copied if
+    // they are not.
+    class Argument_bytes {
+        std::string      m_copy;
+        std::string_view m_bytes;
+    public:
+        explicit Argument_bytes(cppargs::Command_line const command_line)
+        {
+            auto const  arguments = command_line.subspan(1);
+            char const* end       = arguments.empty() ? nullptr : arguments.front();
+            for (auto const argument : arguments) {
+                if (argument != end) {
+                    end = nullptr;
+                    break;
+                }
+                end = argument + std::char_traits<char>::length(argument) + 1;
+            }
+            if (end != nullptr) {
+                m_bytes = std::string_view(arguments.front(), end);
+                return;
+            }
+            for (auto const argument : arguments) {
+                m_copy.append(argument).append(1, '\0');
+            }
+            m_bytes = m_copy;
+        }
+
+        [[nodiscard]] auto view() const noexcept -> std::string_view
+        {
+            return m_bytes;
+        }
+    };
+
+    [[nodiscard]] auto snapshot_key(
+        std::uint64_t const         schema,
+        cppargs::Command_line const command_line,
+        std::string_view const      arguments) noexcept -> std::uint64_t
+    {
+        Hasher hasher;
+        hasher.add_value(schema);
+        hasher.add_value(static_cast<std::uint64_t>(command_line.size()));
+        hasher.add(arguments);
+        return hasher.finish();
+    }
+
+    [[nodiscard]] auto matches_files(
+        std::string_view& input, cppargs::Response_files& response_files) -> bool
+    {
+        auto const count = cppargs::dtl::deserialize_bytes<std::uint64_t>(input);
+        if (!count.has_value()) {
+            return false;
+        }
+        for (std::uint64_t index = 0; index != count.value(); ++index) {
+            auto const path = cppargs::dtl::deserialize_string<std::string_view>(input);
+            auto const hash = cppargs::dtl::deserialize_bytes<std::uint64_t>(input);
+            if (!path.has_value() || !hash.has_value()) {
+                return false;
+            }
+            auto const file = response_files.open(path.value());
+            if (file == nullptr || hash_bytes(file->text) != hash.value()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Storage for values loaded from a snapshot before they are known to be complete
+    class Loaded_values {
+        struct Entry {
+            cppargs::dtl::Parameter_info const* info {};
+            void*                               where {};
+        };
+
+        std::pmr::monotonic_buffer_resource m_buffer;
+        std::vector<Entry>                  m_entries;
+    public:
+        // Room for `count` values is reserved, so that loading one cannot fail after it has been
+        // constructed.
+        explicit Loaded_values(std::size_t const count)
+        {
+            m_entries.reserve(count);
+        }
+
+        Loaded_values(Loaded_values const&)                    = delete;
+        auto operator=(Loaded_values const&) -> Loaded_values& = delete;
+
+        ~Loaded_values()
+        {
+            for (auto const& entry : m_entries) {
+                entry.info->value_type->destroy(entry.where);
+            }
+        }
+
+        // Values allocate from `resource`, so that merging them does not copy.
+        [[nodiscard]] auto load(
+            cppargs::dtl::Parameter_info const& info,
+            std::pmr::memory_resource* const    resource,
+            std::string_view&                   input) -> bool
+        {
+            auto const type  = info.value_type;
+            auto const where = m_buffer.allocate(type->size, type->alignment);
+            type->construct(where, resource);
+            m_entries.push_back({ .info = &info, .where = where });
+            return type->load(where, input);
+        }
+
+        auto merge() -> void
+        {
+            for (auto const& entry : m_entries) {
+                entry.info->value_type->merge(entry.where, entry.info->value);
+            }
+        }
+    };
+
+    // Sets nothing unless every value is loaded and the whole snapshot is consumed
+    [[nodiscard]] auto load_values(
+        std::string_view            input,
+        cppargs::Command_line const command_line,
+        cppargs::Parameters const&  parameters) -> bool
+    {
+        auto const    positionals = parameters.positional_parameters();
+        Loaded_values values(parameters.info_span().size() + positionals.infos.size());
+        bool          loaded = true;
+        for_each_info(parameters, [&](cppargs::dtl::Parameter_info const& info) {
+            loaded = loaded && values.load(info, parameters.resource(), input);
+        });
+        if (!loaded) {
+            return false;
+        }
+        auto const                           trailing = positionals.trailing;
+        std::optional<cppargs::Command_line> trailing_arguments;
+        if (trailing != nullptr) {
+            auto const offset = cppargs::dtl::deserialize_bytes<std::uint64_t>(input);
+            auto const size   = cppargs::dtl::deserialize_bytes<std::uint64_t>(input);
+            if (!offset.has_value() || !size.has_value() || offset.value() > command_line.size()
+                || size.value() > command_line.size() - offset.value())
+            {
+                return false;
+            }
+            trailing_arguments = command_line.subspan(offset.value(), size.value());
+        }
+        if (!input.empty()) {
+            return false;
+        }
+        if (trailing != nullptr) {
+            *trailing = trailing_arguments.value();
+        }
+        values.merge();
+        return true;
+    }
+
+    [[nodiscard]] auto restore_snapshot(
+        std::string_view            input,
+        std::uint64_t const         schema,
+        cppargs::Command_line const command_line,
+        std::string_view const      arguments,
+        cppargs::Parameters const&  parameters,
+        cppargs::Response_files&    response_files) -> bool
+    {
+        using cppargs::dtl::deserialize_bytes;
+        using cppargs::dtl::deserialize_string;
+
+        if (!input.starts_with(magic)) {
+            return false;
+        }
+        input.remove_prefix(magic.size());
+        // A corrupt or truncated snapshot is never decoded, as its counts cannot be trusted.
+        auto const checksum = deserialize_bytes<std::uint64_t>(input);
+        if (checksum != hash_bytes(input)) {
+            return false;
+        }
+        return deserialize_bytes<std::uint64_t>(input) == schema
+            && deserialize_bytes<std::uint64_t>(input) == command_line.size()
+            && deserialize_string<std::string_view>(input) == arguments
+            && matches_files(input, response_files)
+            && load_values(input, command_line, parameters);
+    }
+
+    // Name for a temporary copy of the snapshot at `path`, unique among concurrent stores in this
+    // process and in others. Unlike `std::random_device`, this cannot fail.
+    [[nodiscard]] auto temporary_path(std::string_view const path) -> std::string
+    {
+        static std::atomic<std::uint64_t> counter;
+#if defined(_WIN32)
+        auto const process = _getpid();
+#else
+        auto const process = ::getpid();
+#endif
+        return std::format("{}.{:x}.{:x}.tmp", path, process, counter++);
+    }
+} // namespace
+
+cppargs::Parse_cache::Parse_cache(std::string directory, std::string_view const version)
+    : m_directory(std::move(directory))
+    , m_version(version)
+{}
+
+auto cppargs::Parse_cache::snapshot_path(std::uint64_t const fingerprint) const -> std::string
+{
+    return (std::filesystem::path(m_directory) / std::format("{:016x}.snapshot", fingerprint))
+        .string();
+}
+
+auto cppargs::Parse_cache::fingerprint(Parameters const& parameters) const -> std::uint64_t
+{
+    Hasher hasher;
+    hasher.add(magic);
+    hasher.add_string(m_version);
+
+    auto const positionals = parameters.positional_parameters();
+    hasher.add_value(static_cast<std::uint64_t>(parameters.info_span().size()));
+    hasher.add_value(static_cast<std::uint64_t>(positionals.infos.size()));
+    hasher.add_value(static_cast<std::uint64_t>(positionals.required));
+    hasher.add_value(positionals.variadic);
+    hasher.add_value(positionals.trailing != nullptr);
+
+    for_each_info(parameters, [&](dtl::Parameter_info const& info) {
+        hasher.add_string(info.long_name);
+        hasher.add_value(info.short_name.has_value());
+        hasher.add_value(info.short_name.value_or('\0'));
+        hasher.add_value(info.is_flag);
+        hasher.add_string(info.value_type->signature);
+    });
+    return hasher.finish();
+}
+
+auto cppargs::Parse_cache::is_eligible(Parameters const& parameters) -> bool
+{
+    bool eligible = true;
+    for_each_info(parameters, [&](dtl::Parameter_info const& info) {
+        eligible = eligible && info.value_type->save != nullptr && info.value_type->load != nullptr;
+    });
+    return eligible;
+}
+
+auto cppargs::Parse_cache::open_snapshot(std::string path) -> Source_file const*
+{
+    auto const it = std::ranges::find(m_snapshots, path, &Snapshot::path);
+    if (it != m_snapshots.end()) {
+        return &it->mapping.file(0);
+    }
+    Response_files mapping;
+    auto const     file = mapping.open(path);
+    if (file != nullptr) {
+        m_snapshots.push_back({ .path = std::move(path), .mapping = std::move(mapping) });
+    }
+    return file;
+}
+
+auto cppargs::Parse_cache::restore(
+    Command_line const command_line, Parameters const& parameters, Response_files& response_files)
+    -> bool
+{
+    if (!is_eligible(parameters)) {
+        ++m_misses;
+        return false;
+    }
+    auto const           schema = fingerprint(parameters);
+    Argument_bytes const arguments(command_line);
+
+    auto const file
+        = open_snapshot(snapshot_path(snapshot_key(schema, command_line, arguments.view())));
+    if (file == nullptr
+        || !restore_snapshot(
+            file->text, schema, command_line, arguments.view(), parameters, response_files))
+    {
+        ++m_misses;
+        return false;
+    }
+    ++m_hits;
+    return true;
+}
+
+auto cppargs::Parse_cache::store(
+    Command_line const    command_line,
+    Parameters const&     parameters,
+    Response_files const& response_files) -> void
+{
+    if (!is_eligible(parameters)) {
+        return;
+    }
+    auto const           schema = fingerprint(parameters);
+    Argument_bytes const arguments(command_line);
+
+    std::string snapshot(magic);
+    dtl::serialize_bytes(std::uint64_t {}, snapshot); // Checksum of the rest, filled in below
+    dtl::serialize_bytes(schema, snapshot);
+    dtl::serialize_bytes(static_cast<std::uint64_t>(command_line.size()), snapshot);
+    dtl::serialize_string(arguments.view(), snapshot);
+    dtl::serialize_bytes(static_cast<std::uint64_t>(response_files.size()), snapshot);
+    for (std::size_t index = 0; index != response_files.size(); ++index) {
+        auto const& file = response_files.file(index);
+        dtl::serialize_string(file.path, snapshot);
+        dtl::serialize_bytes(hash_bytes(file.text), snapshot);
+    }
+    for_each_info(parameters, [&](dtl::Parameter_info const& info) {
+        info.value_type->save(info.value, snapshot);
+    });
+    if (auto const trailing = parameters.positional_parameters().trailing) {
+        auto const offset = trailing->empty() ? 0 : trailing->data() - command_line.data();
+        dtl::serialize_bytes(static_cast<std::uint64_t>(offset), snapshot);
+        dtl::serialize_bytes(static_cast<std::uint64_t>(trailing->size()), snapshot);
+    }
+    auto const checksum_offset = magic.size();
+    auto const checksum        = hash_bytes(
+        std::string_view(snapshot).substr(checksum_offset + sizeof(std::uint64_t)));
+    std::memcpy(snapshot.data() + checksum_offset, &checksum, sizeof checksum);
+
+    // Written to a temporary file first, so that a snapshot is never seen half written
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+    auto const path      = snapshot_path(snapshot_key(schema, command_line, arguments.view()));
+    auto const temporary = temporary_path(path);
+    {
+        std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+        stream.write(snapshot.data(), static_cast<std::streamsize>(snapshot.size()));
+        stream.close();
+        if (!stream) {
+            std::filesystem::remove(temporary, ec);
+            return;
+        }
+    }
+    // Mappings of the old file stay valid, as values may refer into them, but are not used again.
+    for (auto& mapped : m_snapshots) {
+        if (mapped.path == path) {
+            mapped.path.clear();
+        }
+    }
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+    }
+}
+
+auto cppargs::Parse_cache::hits() const noexcept -> std::size_t
+{
+    return m_hits;
+}
+
+auto cppargs::Parse_cache::misses() const noexcept -> std::size_t
+{
+    return m_misses;
+}
+
+auto cppargs::Argument<cppargs::Unit>::serialize(Unit, std::string&) -> void {}
+
+auto cppargs::Argument<cppargs::Unit>::deserialize(std::string_view&) -> std::optional<Unit>
+{
+    return Unit {};
+}
+
+auto cppargs::Argument<std::string_view>::serialize(
+    std::string_view const& value, std::string& output) -> void
+{
+    dtl::serialize_string(value, output);
+}
+
+auto cppargs::Argument<std::string_view>::deserialize(std::string_view& input)
+    -> std::optional<std::string_view>
+{
+    return dtl::deserialize_string<std::string_view>(input);
+}
+
+auto cppargs::Argument<std::string>::serialize(std::string const& value, std::string& output)
+    -> void
+{
+    dtl::serialize_string(value, output);
+}
+
+auto cppargs::Argument<std::string>::deserialize(std::string_view& input)
+    -> std::optional<std::string>
+{
+    return dtl::deserialize_string<std::string>(input);
+}
+
+auto cppargs::Argument<std::pmr::string>::serialize(
+    std::pmr::string const& value, std::string& output) -> void
+{
+    dtl::serialize_string(value, output);
+}
+
+auto cppargs::Argument<std::pmr::string>::deserialize(std::string_view& input)
+    -> std::optional<std::pmr::string>
+{
+    return dtl::deserialize_string<std::pmr::string>(input);
+}
+
+auto cppargs::Argument<char>::serialize(char const value, std::string& output) -> void
+{
+    dtl::serialize_bytes(value, output);
+}
+
+auto cppargs::Argument<char>::deserialize(std::string_view& input) -> std::optional<char>
+{
+    return dtl::deserialize_bytes<char>(input);
+}
+
+auto cppargs::Argument<bool>::serialize(bool const value, std::string& output) -> void
+{
+    dtl::serialize_bytes(static_cast<std::uint8_t>(value), output);
+}
+
+auto cppargs::Argument<bool>::deserialize(std::string_view& input) -> std::optional<bool>
+{
+    auto const byte = dtl::deserialize_bytes<std::uint8_t>(input);
+    if (byte == 0 || byte == 1) {
+        return byte == 1;
+    }
+    else {
+        return std::nullopt;
+    }
+}
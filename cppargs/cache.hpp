@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cppargs.hpp>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace cppargs::dtl {
+
+    // Appends the bytes of `value` to `output`
+    template <class T>
+        requires std::is_trivially_copyable_v<T>
+    auto serialize_bytes(T const& value, std::string& output) -> void
+    {
+        output.append(reinterpret_cast<char const*>(&value), sizeof value);
+    }
+
+    // Removes the bytes of a `T` from the start of `input`
+    template <class T>
+        requires std::is_trivially_copyable_v<T>
+    auto deserialize_bytes(std::string_view& input) -> std::optional<T>
+    {
+        if (input.size() < sizeof(T)) {
+            return std::nullopt;
+        }
+        T value;
+        std::memcpy(&value, input.data(), sizeof value);
+        input.remove_prefix(sizeof value);
+        return value;
+    }
+
+    template <class String>
+    auto serialize_string(String const& string, std::string& output) -> void
+    {
+        serialize_bytes(static_cast<std::uint64_t>(string.size()), output);
+        output.append(string.data(), string.size());
+    }
+
+    template <class String>
+    auto deserialize_string(std::string_view& input) -> std::optional<String>
+    {
+        auto const size = deserialize_bytes<std::uint64_t>(input);
+        if (!size.has_value() || size.value() > input.size()) {
+            return std::nullopt;
+        }
+        String string(input.substr(0, size.value()));
+        input.remove_prefix(size.value());
+        return string;
+    }
+
+    // The values stored for a parameter of type `T`, as written to a snapshot
+    template <class T>
+    struct Saved_values {
+        static auto save(Slot<T> const& slot, std::string& output) -> void
+        {
+            serialize_bytes(static_cast<std::uint8_t>(slot.value.has_value()), output);
+            if (slot.value.has_value()) {
+                Argument<T>::serialize(*slot.value, output);
+            }
+        }
+
+        static auto load(Slot<T>& slot, std::string_view& input) -> bool
+        {
+            auto const present = deserialize_bytes<std::uint8_t>(input);
+            if (present != 1) {
+                return present == 0;
+            }
+            auto value = Argument<T>::deserialize(input);
+            if (value.has_value()) {
+                slot.value.emplace(
+                    std::make_obj_using_allocator<T>(slot.allocator, std::move(*value)));
+            }
+            return value.has_value();
+        }
+    };
+
+    template <class T>
+    struct Saved_values<Incremental<T>> {
+        static auto save(std::pmr::vector<T> const& vector, std::string& output) -> void
+        {
+            serialize_bytes(static_cast<std::uint64_t>(vector.size()), output);
+            for (auto const& element : vector) {
+                Argument<T>::serialize(element, output);
+            }
+        }
+
+        // Every element that is not of an empty type takes at least one byte, which bounds the
+        // count read from `input`.
+        static auto load(std::pmr::vector<T>& vector, std::string_view& input) -> bool
+        {
+            auto const size = deserialize_bytes<std::uint64_t>(input);
+            if (!size.has_value() || (!std::is_empty_v<T> && size.value() > input.size())) {
+                return false;
+            }
+            for (std::uint64_t index = 0; index != size.value(); ++index) {
+                auto element = Argument<T>::deserialize(input);
+                if (!element.has_value()) {
+                    return false;
+                }
+                vector.push_back(std::move(*element));
+            }
+            return true;
+        }
+    };
+
+} // namespace cppargs::dtl
+
+namespace cppargs {
+
+    // Stores parsed values in a directory, in snapshot files named by a fingerprint of the
+    // parameters and the arguments. A snapshot is only used if the parameters, the arguments,
+    // and the contents of the response files it was parsed from are all the same. Only
+    // parameters whose `Argument<T>` has `serialize` and `deserialize` members can be stored.
+    // Parameters are fingerprinted by name and type, but not by how their values are converted,
+    // so `version` should change whenever `Argument<T>::parse` does. Snapshots are
+    // memory-mapped, and restored `std::string_view` values refer into them, so this object must
+    // outlive such values.
+    class Parse_cache {
+        struct Snapshot {
+            std::string    path; // Empty once the file has been replaced
+            Response_files mapping;
+        };
+
+        std::string           m_directory;
+        std::string           m_version;
+        std::vector<Snapshot> m_snapshots;
+        std::size_t           m_hits {};
+        std::size_t           m_misses {};
+
+        [[nodiscard]] auto snapshot_path(std::uint64_t fingerprint) const -> std::string;
+        [[nodiscard]] auto fingerprint(Parameters const& parameters) const -> std::uint64_t;
+        [[nodiscard]] auto open_snapshot(std::string path) -> Source_file const*;
+    public:
+        explicit Parse_cache(std::string directory, std::string_view version = {});
+
+        // Whether every parameter can be stored. Others are always parsed.
+        [[nodiscard]] static auto is_eligible(Parameters const& parameters) -> bool;
+
+        // Sets the parameters from the snapshot for `command_line`, opening the response files
+        // it depends on with `response_files`. Returns false, without setting any parameter, if
+        // there is no usable snapshot.
+        [[nodiscard]] auto restore(
+            Command_line      command_line,
+            Parameters const& parameters,
+            Response_files&   response_files) -> bool;
+
+        // Writes the snapshot for `command_line`, which was just parsed into `parameters`
+        // without errors. The snapshot depends on every file opened by `response_files`. Failing
+        // to write is not an error.
+        auto store(
+            Command_line          command_line,
+            Parameters const&     parameters,
+            Response_files const& response_files) -> void;
+
+        [[nodiscard]] auto hits() const noexcept -> std::size_t;
+        [[nodiscard]] auto misses() const noexcept -> std::size_t;
+    };
+
+    // Restores the parameters from `cache` if possible, and otherwise parses the command line and
+    // stores the result. The environment is read in either case.
+    auto parse(
+        Command_line      command_line,
+        Parameters const& parameters,
+        Response_files&   response_files,
+        Parse_cache&      cache) -> void;
+
+    [[nodiscard]] auto try_parse(
+        Command_line      command_line,
+        Parameters const& parameters,
+        Response_files&   response_files,
+        Parse_cache&      cache) -> std::optional<Parse_error>;
+
+} // namespace cppargs
+
+template <class T>
+auto cppargs::dtl::save_values(void const* const where, std::string& output) -> void
+{
+    Saved_values<T>::save(*static_cast<typename Storage<T>::Type const*>(where), output);
+}
+
+template <class T>
+auto cppargs::dtl::load_values(void* const where, std::string_view& input) -> bool
+{
+    return Saved_values<T>::load(*static_cast<typename Storage<T>::Type*>(where), input);
+}
+
+template <std::integral T>
+auto cppargs::Argument<T>::serialize(T const value, std::string& output) -> void
+{
+    dtl::serialize_bytes(value, output);
+}
+
+template <std::integral T>
+auto cppargs::Argument<T>::deserialize(std::string_view& input) -> std::optional<T>
+{
+    return dtl::deserialize_bytes<T>(input);
+}
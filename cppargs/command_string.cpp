@@ -0,0 +1,208 @@
+#include <cppargs.hpp>
+#include <algorithm>
+#include <bit>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CPPARGS_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CPPARGS_SSE2
+#endif
+
+namespace {
+    [[nodiscard]] constexpr auto is_blank(char const character) noexcept -> bool
+    {
+        return character == ' ' || character == '\t' || character == '\n';
+    }
+
+    // Returns a pointer to the first of `characters` in [it, end), or `end`
+    template <char... characters>
+    [[nodiscard]] auto find_first_of(char const* it, char const* const end) noexcept -> char const*
+    {
+#if defined(CPPARGS_AVX2)
+        for (; end - it >= 32; it += 32) {
+            auto const chunk = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(it));
+            auto       mask  = _mm256_setzero_si256();
+            ((mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(characters)))),
+             ...);
+            if (auto const bits = static_cast<std::uint32_t>(_mm256_movemask_epi8(mask))) {
+                return it + std::countr_zero(bits);
+            }
+        }
+#elif defined(CPPARGS_SSE2)
+        for (; end - it >= 16; it += 16) {
+            auto const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(it));
+            auto       mask  = _mm_setzero_si128();
+            ((mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(characters)))), ...);
+            if (auto const bits = static_cast<std::uint32_t>(_mm_movemask_epi8(mask))) {
+                return it + std::countr_zero(bits);
+            }
+        }
+#endif
+        while (it != end && ((*it != characters) && ...)) {
+            ++it;
+        }
+        return it;
+    }
+
+    // Characters that can not appear in an argument that is used as is
+    [[nodiscard]] auto find_special(char const* const it, char const* const end) noexcept
+        -> char const*
+    {
+        return find_first_of<' ', '\t', '\n', '\'', '"', '\\'>(it, end);
+    }
+
+    // Skips whitespace and escaped newlines between arguments
+    [[nodiscard]] auto skip_separators(char const* it, char const* const end) noexcept
+        -> char const*
+    {
+        for (;;) {
+            if (it != end && is_blank(*it)) {
+                ++it;
+            }
+            else if (end - it >= 2 && it[0] == '\\' && it[1] == '\n') {
+                it += 2;
+            }
+            else {
+                return it;
+            }
+        }
+    }
+
+    // Unescapes the argument starting at `it` into `buffer`. Returns the end of the argument, or
+    // null if a quote is not terminated, in which case `quote` is set to the opening quote.
+    [[nodiscard]] auto unescape(
+        char const* it, char const* const end, std::string& buffer, char const*& quote)
+        -> char const*
+    {
+        while (it != end && !is_blank(*it)) {
+            if (*it == '\\') {
+                if (it + 1 == end) {
+                    buffer.push_back('\\');
+                    return end;
+                }
+                if (it[1] != '\n') {
+                    buffer.push_back(it[1]);
+                }
+                it += 2;
+            }
+            else if (*it == '\'') {
+                auto const close = find_first_of<'\''>(it + 1, end);
+                if (close == end) {
+                    quote = it;
+                    return nullptr;
+                }
+                buffer.append(it + 1, close);
+                it = close + 1;
+            }
+            else if (*it == '"') {
+                auto const open = it++;
+                for (;;) {
+                    auto const stop = find_first_of<'"', '\\'>(it, end);
+                    buffer.append(it, stop);
+                    if (stop == end || (*stop == '\\' && stop + 1 == end)) {
+                        quote = open;
+                        return nullptr;
+                    }
+                    if (*stop == '"') {
+                        it = stop + 1;
+                        break;
+                    }
+                    // Within double quotes, a backslash only escapes these characters.
+                    char const next = stop[1];
+                    if (next == '$' || next == '`' || next == '"' || next == '\\') {
+                        buffer.push_back(next);
+                    }
+                    else if (next != '\n') {
+                        buffer.push_back('\\');
+                        buffer.push_back(next);
+                    }
+                    it = stop + 2;
+                }
+            }
+            else {
+                auto const stop = find_special(it, end);
+                buffer.append(it, stop);
+                it = stop;
+            }
+        }
+        return it;
+    }
+} // namespace
+
+cppargs::Command_string::Command_string(std::string_view const string)
+    : m_source { .path = {}, .text = string }
+{
+    struct Buffered {
+        std::size_t argument {};
+        std::size_t offset {};
+        std::size_t size {};
+    };
+
+    std::vector<Buffered> buffered;
+
+    char const* const begin = string.data();
+    char const* const end   = begin + string.size();
+
+    for (char const* it = skip_separators(begin, end); it != end; it = skip_separators(it, end)) {
+        char const* const start = it;
+        it                      = find_special(it, end);
+
+        if (it == end || is_blank(*it)) {
+            m_arguments.emplace_back(start, it);
+        }
+        else {
+            auto const  offset = m_buffer.size();
+            char const* quote  = nullptr;
+            m_buffer.append(start, it);
+            it = unescape(it, end, m_buffer, quote);
+            if (it == nullptr) {
+                m_unterminated_quote = static_cast<std::size_t>(quote - begin);
+                m_buffer.resize(offset);
+                break;
+            }
+            buffered.push_back({ m_arguments.size(), offset, m_buffer.size() - offset });
+            m_arguments.emplace_back();
+        }
+        m_extents.push_back({
+            .offset = static_cast<std::size_t>(start - begin),
+            .size   = static_cast<std::size_t>(it - start),
+        });
+    }
+
+    // The buffer no longer grows, so views into it are stable.
+    for (auto const& [argument, offset, size] : buffered) {
+        m_arguments[argument] = std::string_view(m_buffer).substr(offset, size);
+    }
+}
+
+auto cppargs::Command_string::arguments() const noexcept -> std::span<std::string_view const>
+{
+    return m_arguments;
+}
+
+auto cppargs::Command_string::source() const noexcept -> Source_file const&
+{
+    return m_source;
+}
+
+auto cppargs::Command_string::unterminated_quote() const noexcept -> std::optional<std::size_t>
+{
+    return m_unterminated_quote;
+}
+
+auto cppargs::Command_string::locate(
+    std::size_t const argument, std::string_view const view) const noexcept -> std::string_view
+{
+    auto const text = m_source.text;
+    if (view.data() >= text.data() && view.data() <= text.data() + text.size()) {
+        return view;
+    }
+    // Unescaped arguments do not correspond to the original string character by character,
+    // so the view is clamped to the extent of the argument.
+    auto const [offset, size] = m_extents[argument];
+    auto const skip
+        = std::min(size, static_cast<std::size_t>(view.data() - m_arguments[argument].data()));
+    return text.substr(offset + skip, std::min(view.size(), size - skip));
+}
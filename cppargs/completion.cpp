@@ -0,0 +1,321 @@
+#include <cppargs.hpp>
+#include <completion.hpp>
+#include <algorithm>
+#include <charconv>
+#include <format>
+
+namespace {
+    // Where the argument being completed would go
+    struct Context {
+        cppargs::dtl::Parameter_info const* pending {}; // The option awaiting a value, or null
+        std::size_t                         positional_count {};
+        bool                                options_ended {};
+    };
+
+    // Follows the arguments before the one being completed, without converting any of them
+    [[nodiscard]] auto scan(
+        cppargs::Command_line const command_line,
+        std::size_t const           index,
+        cppargs::Parameters const&  parameters) -> Context
+    {
+        Context context;
+        for (std::size_t argument = 1; argument < index; ++argument) {
+            std::string_view const string = command_line[argument];
+            if (context.pending != nullptr) {
+                context.pending = nullptr;
+            }
+            else if (context.options_ended || string == "-" || !string.starts_with('-')) {
+                ++context.positional_count;
+            }
+            else if (string == "--") {
+                context.options_ended = true;
+            }
+            else if (string.starts_with("--")) {
+                auto const info = parameters.match(string.substr(2));
+                if (info != nullptr && !info->is_flag) {
+                    context.pending = info;
+                }
+            }
+            else {
+                // The first option that takes a value takes the rest of the cluster.
+                for (auto it = string.begin() + 1; it != string.end(); ++it) {
+                    auto const info = parameters.find(*it);
+                    if (info != nullptr && !info->is_flag) {
+                        context.pending = it + 1 == string.end() ? info : nullptr;
+                        break;
+                    }
+                }
+            }
+        }
+        return context;
+    }
+
+    auto add_values(
+        std::vector<std::string>&                     candidates,
+        cppargs::dtl::Parameter_help::Complete* const complete,
+        std::string_view const                        prefix) -> void
+    {
+        if (complete == nullptr) {
+            return;
+        }
+        for (auto& value : complete(prefix)) {
+            if (value.starts_with(prefix)) {
+                candidates.push_back(std::move(value));
+            }
+        }
+    }
+
+    // Option names starting with `prefix`, which starts with a dash. The parameters are scanned
+    // once instead of sorting every long name, since a completing process answers one query.
+    auto add_options(
+        std::vector<std::string>&  candidates,
+        cppargs::Parameters const& parameters,
+        std::string_view const     prefix) -> void
+    {
+        if (prefix == "-" || prefix.starts_with("--")) {
+            auto const rest = prefix.substr(std::min<std::size_t>(prefix.size(), 2));
+
+            std::vector<std::string_view> names;
+            for (auto const& info : parameters.info_span()) {
+                if (info.long_name.starts_with(rest)) {
+                    names.push_back(info.long_name);
+                }
+            }
+            std::ranges::sort(names);
+            names.erase(std::ranges::unique(names).begin(), names.end());
+            for (auto const name : names) {
+                candidates.push_back(std::format("--{}", name));
+            }
+        }
+        if (prefix.size() <= 2 && !prefix.starts_with("--")) {
+            for (auto const& info : parameters.info_span()) {
+                if (info.short_name.has_value()
+                    && (prefix.size() == 1 || prefix[1] == info.short_name.value()))
+                {
+                    candidates.push_back(std::format("-{}", info.short_name.value()));
+                }
+            }
+        }
+    }
+
+    // Every option name, as typed on the command line
+    [[nodiscard]] auto option_names(cppargs::Parameters const& parameters)
+        -> std::vector<std::string>
+    {
+        std::vector<std::string> names;
+        for (auto const name : parameters.long_names()) {
+            names.push_back(std::format("--{}", name));
+        }
+        for (auto const& info : parameters.info_span()) {
+            if (info.short_name.has_value()) {
+                names.push_back(std::format("-{}", info.short_name.value()));
+            }
+        }
+        return names;
+    }
+
+    // Quotes `string` as a single word for bash and zsh
+    [[nodiscard]] auto quote(std::string_view const string) -> std::string
+    {
+        std::string quoted = "'";
+        for (char const character : string) {
+            quoted.append(character == '\'' ? "'\\''" : std::string_view(&character, 1));
+        }
+        return quoted.append(1, '\'');
+    }
+
+    // Quotes `string` as a single word for fish, where backslashes also escape in single quotes
+    [[nodiscard]] auto quote_fish(std::string_view const string) -> std::string
+    {
+        std::string quoted = "'";
+        for (char const character : string) {
+            if (character == '\'' || character == '\\') {
+                quoted.append(1, '\\');
+            }
+            quoted.append(1, character);
+        }
+        return quoted.append(1, '\'');
+    }
+
+    // `program` as part of a shell function name
+    [[nodiscard]] auto function_name(std::string_view const program) -> std::string
+    {
+        std::string name(program.substr(std::min(program.size(), program.rfind('/') + 1)));
+        std::ranges::replace_if(
+            name,
+            [](char const character) {
+                return !(character >= 'a' && character <= 'z')
+                    && !(character >= 'A' && character <= 'Z')
+                    && !(character >= '0' && character <= '9');
+            },
+            '_');
+        return name;
+    }
+
+    [[nodiscard]] auto bash_script(
+        std::string_view const program, cppargs::Parameters const& parameters) -> std::string
+    {
+        std::string words;
+        for (auto const& name : option_names(parameters)) {
+            words.append(words.empty() ? "" : " ").append(name);
+        }
+        return std::format(
+            "# bash completion for {0}, generated by cppargs\n"
+            "_cppargs_{1}() {{\n"
+            "    local current=\"${{COMP_WORDS[COMP_CWORD]}}\"\n"
+            "    if [[ \"$current\" == -* ]]; then\n"
+            "        mapfile -t COMPREPLY < <(compgen -W {2} -- \"$current\")\n"
+            "    else\n"
+            "        mapfile -t COMPREPLY < <(CPPARGS_COMPLETE=\"$COMP_CWORD\" "
+            "\"${{COMP_WORDS[@]:0:COMP_CWORD+1}}\" 2>/dev/null)\n"
+            "    fi\n"
+            "}}\n"
+            "complete -o default -F _cppargs_{1} {3}\n",
+            program,
+            function_name(program),
+            quote(words),
+            quote(program));
+    }
+
+    [[nodiscard]] auto zsh_script(
+        std::string_view const program, cppargs::Parameters const& parameters) -> std::string
+    {
+        std::string words;
+        for (auto const& name : option_names(parameters)) {
+            words.append(" ").append(quote(name));
+        }
+        return std::format(
+            "#compdef {0}\n"
+            "# zsh completion for {0}, generated by cppargs\n"
+            "_cppargs_{1}() {{\n"
+            "    local -a candidates\n"
+            "    if [[ $PREFIX == -* ]]; then\n"
+            "        candidates=({2})\n"
+            "    else\n"
+            "        candidates=(${{(f)\"$(CPPARGS_COMPLETE=$((CURRENT - 1)) "
+            "\"${{(@)words[1,CURRENT]}}\" 2>/dev/null)\"}})\n"
+            "    fi\n"
+            "    if (( $#candidates )); then\n"
+            "        compadd -a candidates\n"
+            "    else\n"
+            "        _files\n"
+            "    fi\n"
+            "}}\n"
+            "compdef _cppargs_{1} {3}\n",
+            program,
+            function_name(program),
+            words.empty() ? words : words.substr(1),
+            quote(program));
+    }
+
+    [[nodiscard]] auto fish_script(
+        std::string_view const program, cppargs::Parameters const& parameters) -> std::string
+    {
+        auto script = std::format("# fish completion for {}, generated by cppargs\n", program);
+        for (auto const& info : parameters.info_span()) {
+            auto const& help = parameters.help_of(info);
+            std::format_to(std::back_inserter(script), "complete -c {}", quote_fish(program));
+            if (info.short_name.has_value()) {
+                std::format_to(
+                    std::back_inserter(script),
+                    " -s {}",
+                    quote_fish(std::string_view(&info.short_name.value(), 1)));
+            }
+            std::format_to(std::back_inserter(script), " -l {}", quote_fish(info.long_name));
+            if (!info.is_flag) {
+                script.append(" -r");
+            }
+            if (!help.description.empty()) {
+                std::format_to(
+                    std::back_inserter(script), " -d {}", quote_fish(help.description));
+            }
+            script.append("\n");
+        }
+        std::format_to(
+            std::back_inserter(script),
+            "function __cppargs_{0}\n"
+            "    set -l words (commandline -opc) (commandline -ct)\n"
+            "    env CPPARGS_COMPLETE=(math (count $words) - 1) $words 2>/dev/null\n"
+            "end\n"
+            "complete -c {1} -a '(__cppargs_{0})'\n",
+            function_name(program),
+            quote_fish(program));
+        return script;
+    }
+} // namespace
+
+auto cppargs::complete(
+    Command_line const command_line, std::size_t const index, Parameters const& parameters)
+    -> std::vector<std::string>
+{
+    dtl::validate_command_line(command_line);
+    if (index == 0 || index > command_line.size()) {
+        return {};
+    }
+    std::string_view const prefix  = index == command_line.size() ? "" : command_line[index];
+    auto const             context = scan(command_line, index, parameters);
+
+    std::vector<std::string> candidates;
+    if (context.pending != nullptr) {
+        add_values(candidates, parameters.help_of(*context.pending).complete, prefix);
+    }
+    else if (!context.options_ended && prefix.starts_with('-')) {
+        add_options(candidates, parameters, prefix);
+    }
+    else if (!context.options_ended || parameters.positional_parameters().trailing == nullptr) {
+        auto const positionals = parameters.positional_parameters();
+        auto const last        = positionals.infos.size() - 1;
+        auto const position    = positionals.variadic ? std::min(context.positional_count, last)
+                                                      : context.positional_count;
+        if (position < positionals.infos.size()) {
+            add_values(candidates, positionals.helps[position].complete, prefix);
+        }
+    }
+    return candidates;
+}
+
+auto cppargs::answer_completion(
+    Command_line const command_line,
+    Parameters const&  parameters,
+    std::FILE* const   output,
+    Environment const  environment) -> bool
+{
+    constexpr std::string_view variable = "CPPARGS_COMPLETE=";
+
+    auto const it = std::ranges::find_if(environment, [&](char const* const entry) {
+        return entry != nullptr && std::string_view(entry).starts_with(variable);
+    });
+    if (it == environment.end()) {
+        return false;
+    }
+    auto const  value = std::string_view(*it).substr(variable.size());
+    std::size_t index {};
+    auto const  end   = value.data() + value.size();
+    if (auto const [stop, error] = std::from_chars(value.data(), end, index);
+        error != std::errc {} || stop != end)
+    {
+        return false;
+    }
+    for (auto const& candidate : complete(command_line, index, parameters)) {
+        (void)std::fwrite(candidate.data(), 1, candidate.size(), output);
+        (void)std::fputc('\n', output);
+    }
+    return true;
+}
+
+auto cppargs::completion_script(
+    Shell const shell, std::string_view const program, Parameters const& parameters) -> std::string
+{
+    switch (shell) {
+    case Shell::bash:
+        return bash_script(program, parameters);
+    case Shell::zsh:
+        return zsh_script(program, parameters);
+    case Shell::fish:
+        return fish_script(program, parameters);
+    default:
+        throw std::invalid_argument {
+            "cppargs::completion_script: Invalid Shell enumerator value",
+        };
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cppargs.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cppargs {
+
+    // Candidates for completing the argument at `index` of `command_line`, which is the partial
+    // argument before the cursor, or one past the end for a new argument. An argument starting
+    // with `-` is completed with option names, and any other with values from the
+    // `Argument<T>::complete` function of the option before it, or of the positional parameter
+    // it would be given to, if there is one. Values that do not start with the partial argument
+    // are left out. Nothing is parsed or converted.
+    [[nodiscard]] auto complete(
+        Command_line command_line, std::size_t index, Parameters const& parameters)
+        -> std::vector<std::string>;
+
+    // Answers a completion query from a script made by `completion_script`: if the environment
+    // variable `CPPARGS_COMPLETE` holds an index, writes the candidates for the argument at that
+    // index to `output`, one per line, and returns true. Call this first thing in `main`, and
+    // return right away if it answers, so that completion does not wait for initialization.
+    [[nodiscard]] auto answer_completion(
+        Command_line      command_line,
+        Parameters const& parameters,
+        std::FILE*        output      = stdout,
+        Environment       environment = process_environment()) -> bool;
+
+    enum class Shell : std::uint8_t { bash, zsh, fish };
+
+    // Completion script for `program`, meant to be generated at build time. Option names are
+    // completed by the script itself, and the program is only run to complete values, through
+    // `answer_completion`. Without candidates, shells fall back to completing file names.
+    [[nodiscard]] auto completion_script(
+        Shell shell, std::string_view program, Parameters const& parameters) -> std::string;
+
+} // namespace cppargs
@@ -0,0 +1,107 @@
+#include <cppargs.hpp>
+#include <algorithm>
+
+namespace {
+    using Kind = cppargs::Parse_error_info::Kind;
+
+    [[nodiscard]] auto trim(std::string_view const string) noexcept -> std::string_view
+    {
+        constexpr std::string_view blank = " \t\r\v\f";
+
+        auto const begin = string.find_first_not_of(blank);
+        if (begin == std::string_view::npos) {
+            return {};
+        }
+        return string.substr(begin, string.find_last_not_of(blank) - begin + 1);
+    }
+
+    [[nodiscard]] auto unquote(std::string_view const value) noexcept -> std::string_view
+    {
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+            return value.substr(1, value.size() - 2);
+        }
+        return value;
+    }
+
+    // Whether a parameter is set by this file, decided by its first key in the file
+    enum class State : std::uint8_t { undecided, apply, skip };
+} // namespace
+
+auto cppargs::try_parse_config(Source_file const& file, Parameters const& parameters)
+    -> std::optional<Parse_error>
+{
+    auto const text  = file.text;
+    auto const infos = parameters.info_span();
+    auto const error = [&](Kind const                        kind,
+                           std::string_view const            view,
+                           std::span<std::string_view const> choices = {}) {
+        return Parse_error({}, 0, kind, view, &file, choices);
+    };
+
+    std::vector<State> states(infos.size());
+    std::string        name; // Section prefix followed by the current key
+    std::size_t        prefix_size = 0;
+
+    for (std::size_t position = 0; position < text.size();) {
+        auto const end  = std::min(text.find('\n', position), text.size());
+        auto const line = trim(text.substr(position, end - position));
+        position        = end + 1;
+
+        if (line.empty() || line.front() == '#' || line.front() == ';') {
+            continue;
+        }
+        if (line.front() == '[') {
+            if (line.back() != ']') {
+                return error(Kind::malformed_line, line);
+            }
+            auto const section = trim(line.substr(1, line.size() - 2));
+            name.assign(section);
+            if (!section.empty()) {
+                name.push_back('-');
+            }
+            prefix_size = name.size();
+            continue;
+        }
+
+        auto const equals = line.find('=');
+        auto const key    = trim(line.substr(0, equals));
+        if (key.empty()) {
+            return error(Kind::malformed_line, line);
+        }
+        name.resize(prefix_size);
+        name.append(key);
+
+        auto const info = parameters.find(name);
+        if (info == nullptr) {
+            return error(Kind::unrecognized_option, key);
+        }
+
+        auto& state = states[static_cast<std::size_t>(info - infos.data())];
+        if (state == State::undecided) {
+            state = info->value_type->has_value(info->value) ? State::skip : State::apply;
+        }
+        if (state == State::skip) {
+            continue;
+        }
+
+        if (equals == std::string_view::npos) {
+            if (!info->is_flag) {
+                return error(Kind::missing_argument, key);
+            }
+            (void)info->parse({}, info->value);
+        }
+        else if (auto const value = unquote(trim(line.substr(equals + 1)));
+                 !dtl::parse_setting(*info, value))
+        {
+            return error(Kind::invalid_argument, value, info->value_type->choices);
+        }
+    }
+    return std::nullopt;
+}
+
+auto cppargs::parse_config(Source_file const& file, Parameters const& parameters) -> void
+{
+    if (auto const error = try_parse_config(file, parameters)) {
+        throw Exception(error->info(parameters));
+    }
+}
@@ -0,0 +1,76 @@
+module;
+
+#include <cppargs.hpp>
+#include <static_parameters.hpp>
+#include <enum_argument.hpp>
+#include <bounded_queue.hpp>
+#include <observer.hpp>
+#include <cache.hpp>
+#include <diagnostics.hpp>
+#include <completion.hpp>
+#include <schema.hpp>
+#include <parser.hpp>
+#include <subcommands.hpp>
+
+export module cppargs;
+
+export namespace cppargs {
+    using cppargs::Command_line;
+    using cppargs::Environment;
+    using cppargs::Parse_error_info;
+    using cppargs::Source_file;
+    using cppargs::Parse_error;
+    using cppargs::Exception;
+    using cppargs::Response_files;
+    using cppargs::Command_string;
+    using cppargs::Unit;
+    using cppargs::Incremental;
+    using cppargs::List;
+    using cppargs::Sink;
+    using cppargs::Argument;
+    using cppargs::argument;
+    using cppargs::Parameter;
+    using cppargs::Trailing_arguments;
+    using cppargs::Presence;
+    using cppargs::Parameters;
+    using cppargs::Values;
+    using cppargs::Key;
+    using cppargs::Schema;
+    using cppargs::Subcommands;
+    using cppargs::Diagnostics;
+    using cppargs::Parser;
+    using cppargs::Parse_cache;
+    using cppargs::Counting_resource;
+    using cppargs::Token_event;
+    using cppargs::Parse_stats;
+    using cppargs::Parse_observer;
+    using cppargs::Shell;
+
+    using cppargs::parse;
+    using cppargs::try_parse;
+    using cppargs::parse_all;
+    using cppargs::process_environment;
+    using cppargs::parse_environment;
+    using cppargs::try_parse_environment;
+    using cppargs::parse_config;
+    using cppargs::try_parse_config;
+    using cppargs::parse_parallel;
+    using cppargs::try_parse_parallel;
+    using cppargs::complete;
+    using cppargs::answer_completion;
+    using cppargs::completion_script;
+
+    using cppargs::Fixed_string;
+    using cppargs::Option;
+    using cppargs::option;
+    using cppargs::Static_parameter;
+    using cppargs::Static_parameters;
+
+    using cppargs::Case;
+    using cppargs::Enum_name;
+    using cppargs::Enum_names;
+    using cppargs::enum_names;
+    using cppargs::Enum_argument;
+
+    using cppargs::Bounded_queue;
+} // namespace cppargs
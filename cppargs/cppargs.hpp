@@ -4,11 +4,19 @@
 #include <exception>
 #include <optional>
 #include <charconv>
+#include <unordered_map>
+#include <memory_resource>
 #include <utility>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
+#include <array>
 #include <span>
+#include <cstdio>
+#include <functional>
+#include <iterator>
 
 namespace cppargs {
 
@@ -19,6 +27,13 @@ namespace cppargs {
             missing_argument,
             invalid_argument,
             positional_argument,
+            unreadable_response_file,
+            recursive_response_file,
+            unterminated_quote,
+            malformed_line,
+            missing_positional_argument,
+            missing_subcommand,
+            unrecognized_subcommand,
         };
 
         std::string command_line;
@@ -26,22 +41,175 @@ namespace cppargs {
         std::size_t error_column {};
         std::size_t error_width {};
 
+        // For errors in files and command strings, `command_line` is the line containing the
+        // error and `error_line` is its line number. For files, `source` is the path of the file;
+        // for command strings, it is empty.
+        std::string source;
+        std::size_t error_line = 1;
+
+        // Names that were probably meant by an unrecognized option, or arguments that were
+        // probably meant by an invalid one, closest first
+        std::vector<std::string> suggestions;
+
+        // For an invalid argument of a parameter that takes one of a fixed set of arguments,
+        // every valid one
+        std::vector<std::string> choices;
+
         static auto kind_to_string(Kind) -> std::string_view;
     };
 
+    using Command_line = std::span<char const* const>;
+
+    // Environment variables as `NAME=value` strings
+    using Environment = std::span<char const* const>;
+
+    // Text that arguments are read from, other than the command line itself
+    struct Source_file {
+        std::string      path;
+        std::string_view text;
+    };
+
+    // Parse failure that does not allocate. The column, the command line string, and the
+    // message are only computed on request. Refers to the command line it was produced from.
+    class Parse_error {
+        Command_line                      m_command_line;
+        std::size_t                       m_argument {};
+        std::size_t                       m_offset {}; // Of `m_view` in its argument or file
+        std::string_view                  m_view;
+        Parse_error_info::Kind            m_kind {};
+        Source_file const*                m_file {};
+        std::span<std::string_view const> m_choices;
+    public:
+        // `view` must point into the argument at index `argument` of `command_line`, or into
+        // the text of `file` if the error is in a file or a command string. If that argument is a
+        // null `argv[0]`, `view` must be empty and is taken to be at its start. `choices` are the
+        // valid arguments of the parameter, if it only takes a fixed set of them.
+        Parse_error(
+            Command_line                      command_line,
+            std::size_t                       argument,
+            Parse_error_info::Kind            kind,
+            std::string_view                  view,
+            Source_file const*                file    = nullptr,
+            std::span<std::string_view const> choices = {}) noexcept;
+
+        [[nodiscard]] auto kind() const noexcept -> Parse_error_info::Kind;
+
+        // The erroneous part of the command line
+        [[nodiscard]] auto view() const noexcept -> std::string_view;
+
+        // Index of the command line argument that contains the error, or that names the
+        // outermost response file containing it
+        [[nodiscard]] auto argument_index() const noexcept -> std::size_t;
+
+        // The file or command string containing the error, or null
+        [[nodiscard]] auto file() const noexcept -> Source_file const*;
+
+        // The valid arguments, if the parameter of an invalid argument only takes a fixed set
+        [[nodiscard]] auto choices() const noexcept -> std::span<std::string_view const>;
+
+        [[nodiscard]] auto line() const noexcept -> std::size_t;
+        [[nodiscard]] auto column() const noexcept -> std::size_t;
+        [[nodiscard]] auto command_line_string() const -> std::string;
+        [[nodiscard]] auto message() const -> std::string;
+        [[nodiscard]] auto info() const -> Parse_error_info;
+
+        // Long names in `parameters` that an unrecognized option was probably meant to be,
+        // closest first. Empty for other errors, and for single characters, which are short names
+        // or too short to suggest anything for.
+        template <class Parameters>
+        [[nodiscard]] auto suggestions(Parameters const& parameters) const
+            -> std::vector<std::string_view>
+        {
+            if (m_kind != Parse_error_info::Kind::unrecognized_option || m_view.size() <= 1) {
+                return {};
+            }
+            return parameters.suggest(m_view);
+        }
+
+        // Like `info`, with the suggestions from `parameters` for an unrecognized option
+        template <class Parameters>
+        [[nodiscard]] auto info(Parameters const& parameters) const -> Parse_error_info
+        {
+            auto info = this->info();
+            for (auto const name : suggestions(parameters)) {
+                info.suggestions.emplace_back(name);
+            }
+            return info;
+        }
+    };
+
     // Thrown on parse failure
     class Exception : public std::exception {
         std::string      m_exception_string;
         Parse_error_info m_parse_error_info;
     public:
         explicit Exception(Parse_error_info&&);
+        explicit Exception(Parse_error const&);
 
         // Makes custom error message formatting possible
         [[nodiscard]] auto info() const noexcept -> Parse_error_info const&;
         [[nodiscard]] auto what() const noexcept -> char const* override;
     };
 
-    using Command_line = std::span<char const* const>;
+    // Enables expansion of `@file` arguments. A response file holds whitespace separated
+    // arguments, and may refer to other response files. Files are memory-mapped and their
+    // arguments are parsed in place, so `std::string_view` values refer into the mapping.
+    // This object must outlive such values, as well as any `Parse_error` referring to a file.
+    class Response_files {
+        struct Mapping;
+        std::vector<std::unique_ptr<Mapping>> m_mappings;
+    public:
+        Response_files();
+        Response_files(Response_files&&) noexcept;
+        auto operator=(Response_files&&) noexcept -> Response_files&;
+        ~Response_files();
+
+        // Maps the file at `path`, or returns the existing mapping if the same file has
+        // already been opened. Returns null if the file could not be read.
+        [[nodiscard]] auto open(std::string_view path) -> Source_file const*;
+
+        // The number of files opened so far
+        [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+        // The file opened at position `index`, counting from the first one
+        [[nodiscard]] auto file(std::size_t index) const noexcept -> Source_file const&;
+    };
+
+    // Splits a string into arguments following POSIX shell quoting rules. Arguments are separated
+    // by whitespace; single quotes, double quotes, and backslashes work as in `sh`, but there is
+    // no expansion of any kind. Arguments without quotes or escapes refer into the string, the
+    // rest refer into an internal buffer. The string must outlive this object, which must in
+    // turn outlive any `Parse_error` or `std::string_view` value referring to it.
+    class Command_string {
+        struct Extent {
+            std::size_t offset {};
+            std::size_t size {};
+        };
+
+        Source_file                   m_source;
+        std::string                   m_buffer;
+        std::vector<std::string_view> m_arguments;
+        std::vector<Extent>           m_extents;
+        std::optional<std::size_t>    m_unterminated_quote;
+    public:
+        explicit Command_string(std::string_view string);
+
+        Command_string(Command_string const&)                    = delete;
+        auto operator=(Command_string const&) -> Command_string& = delete;
+
+        // The arguments, not including a program name
+        [[nodiscard]] auto arguments() const noexcept -> std::span<std::string_view const>;
+
+        [[nodiscard]] auto source() const noexcept -> Source_file const&;
+
+        // Offset of a quote that is never closed. Arguments after it are not split.
+        [[nodiscard]] auto unterminated_quote() const noexcept -> std::optional<std::size_t>;
+
+        // Maps `view`, which points into the argument at index `argument`, back into the string.
+        // For unescaped arguments the result is approximate.
+        [[nodiscard]] auto locate(std::size_t argument, std::string_view view) const noexcept
+            -> std::string_view;
+    };
 
     // Regular void
     struct Unit {};
@@ -50,6 +218,16 @@ namespace cppargs {
     template <class>
     struct Incremental {};
 
+    // Vector built from a single argument whose elements are separated by `separator`. When the
+    // parameter is given more than once, the elements are appended.
+    template <class, char separator = ','>
+    struct List {};
+
+    // Values passed to a callback one at a time as soon as they are parsed, instead of being
+    // stored. Added with `Parameters::add_sink`.
+    template <class>
+    struct Sink {};
+
     template <class>
     struct Argument {};
 
@@ -57,21 +235,82 @@ namespace cppargs {
 
 namespace cppargs::dtl {
 
+    struct Value_type;
+
+    // What matching and parsing need to know about a parameter. Kept to 48 bytes on 64-bit
+    // targets, so that lookups and scans over large parameter tables touch few cache lines.
     struct Parameter_info {
         using Parse = auto(std::string_view, void*) -> bool;
         Parse*              parse {};
         void*               value {};
-        bool                is_flag {};
-        std::string_view    type_name;
+        Value_type const*   value_type {};
         std::string_view    long_name;
         std::optional<char> short_name;
-        std::string_view    description;
+        bool                is_flag {};
+    };
+
+    // What only help text and completion need, in a table parallel to the `Parameter_info` one
+    struct Parameter_help {
+        using Complete = auto(std::string_view prefix) -> std::vector<std::string>;
+        std::string_view type_name;
+        std::string_view description;
+        Complete*        complete {}; // Completes values, or null
+    };
+
+    // Enables lookup with `std::string_view` in unordered containers of strings
+    struct String_hash {
+        using is_transparent = void;
+
+        auto operator()(std::string_view const string) const noexcept -> std::size_t
+        {
+            return std::hash<std::string_view> {}(string);
+        }
     };
 
+    class Sorted_names; // Defined in suggestions.hpp, which only the library includes
+
+    // Owns the long names of a `Parameters` object in sorted order, which are built on first use.
+    // Copies build their own.
+    class Sorted_names_ptr {
+        Sorted_names* m_names;
+    public:
+        explicit Sorted_names_ptr(std::pmr::memory_resource* resource);
+        Sorted_names_ptr(Sorted_names_ptr const& other);
+        auto operator=(Sorted_names_ptr const&) -> Sorted_names_ptr&;
+        ~Sorted_names_ptr();
+
+        auto operator->() const noexcept -> Sorted_names*;
+    };
+
+    // Type-erased destination for help text
+    struct Help_writer {
+        using Write = auto(void* context, std::string_view text) -> void;
+        Write* write {};
+        void*  context {};
+    };
+
+    // Parses a value that does not come from the command line. Flags take boolean values, such
+    // as `1` or `false`, instead of being set by their presence.
+    auto parse_setting(Parameter_info const& info, std::string_view value) -> bool;
+
+    // Throws `std::invalid_argument` if the command line is malformed
+    auto validate_command_line(Command_line command_line) -> void;
+
+    // Adds the choices to `info`, and suggests the ones closest to the invalid argument `view`
+    auto add_choices(
+        Parse_error_info& info, std::string_view view, std::span<std::string_view const> choices)
+        -> void;
+
+    template <class>
+    struct List_type_name {};
+
     template <class T>
     consteval auto type_name() -> std::string_view
     {
-        if constexpr (requires { Argument<T>::type_name; }) {
+        if constexpr (requires { List_type_name<T>::value; }) {
+            return List_type_name<T>::value;
+        }
+        else if constexpr (requires { Argument<T>::type_name; }) {
             return Argument<T>::type_name;
         }
         else {
@@ -79,12 +318,113 @@ namespace cppargs::dtl {
         }
     }
 
+    // "int,..." for `List<int>`, shown in help text as "[int,...]"
+    template <class T, char separator>
+    struct List_type_name<List<T, separator>> {
+        static constexpr auto characters = [] {
+            constexpr std::string_view element = type_name<T>();
+            std::array<char, element.size() + 4> array {};
+            element.copy(array.data(), element.size());
+            array[element.size()] = separator;
+            std::string_view("...").copy(array.data() + element.size() + 1, 3);
+            return array;
+        }();
+
+        static constexpr std::string_view value { characters.data(), characters.size() };
+    };
+
+    // Whether values of type `T` can be stored by a `Parse_cache`
+    template <class T>
+    concept serializable = requires(T const& value, std::string& output, std::string_view& input) {
+        Argument<T>::serialize(value, output);
+        // clang-format off
+        { Argument<T>::deserialize(input) } -> std::same_as<std::optional<T>>;
+        // clang-format on
+    };
+
+    // `Argument<T>::complete`, if there is one
+    template <class T>
+    struct Completion {
+        static constexpr Parameter_help::Complete* value = nullptr;
+    };
+
+    template <class T>
+        requires requires(std::string_view const prefix) {
+            // clang-format off
+            { Argument<T>::complete(prefix) } -> std::same_as<std::vector<std::string>>;
+            // clang-format on
+        }
+    struct Completion<T> {
+        static constexpr Parameter_help::Complete* value = Argument<T>::complete;
+    };
+
+    template <class T>
+    struct Completion<Incremental<T>> : Completion<T> {};
+
+    // Storage for the value of a non-incremental parameter. Allocator-aware values are
+    // constructed with `allocator`, so they allocate from the same memory resource.
+    template <class T>
+    struct Slot {
+        std::pmr::polymorphic_allocator<> allocator;
+        std::optional<T>                  value;
+    };
+
+    // Storage of a sink parameter. Values are passed to `consume`, or buffered while it is null,
+    // as in temporary storage that is merged later.
+    template <class T>
+    struct Sink_slot {
+        std::function<auto(T)->void> consume;
+        std::pmr::vector<T>          buffer;
+        std::size_t                  count {};
+
+        explicit Sink_slot(
+            std::pmr::memory_resource* const resource, std::function<auto(T)->void> consume = {})
+            : consume(std::move(consume))
+            , buffer(resource)
+        {}
+
+        auto push(T&& value) -> void
+        {
+            if (consume) {
+                consume(std::move(value));
+            }
+            else {
+                buffer.push_back(std::move(value));
+            }
+            ++count;
+        }
+    };
+
+    template <class T>
+    struct Resource_delete {
+        std::pmr::memory_resource* resource {};
+
+        auto operator()(T* const pointer) const -> void
+        {
+            std::pmr::polymorphic_allocator<>(resource).delete_object(pointer);
+        }
+    };
+
+    template <class T>
+    using Resource_ptr = std::unique_ptr<T, Resource_delete<T>>;
+
+    template <class T, class... Args>
+    auto make_resource_ptr(std::pmr::memory_resource* const resource, Args&&... args)
+        -> Resource_ptr<T>
+    {
+        std::pmr::polymorphic_allocator<> allocator(resource);
+        return Resource_ptr<T>(
+            allocator.new_object<T>(std::forward<Args>(args)...), Resource_delete<T> { resource });
+    }
+
     template <class T>
     struct Parse {
         static auto parse(std::string_view const string, void* const where) -> bool
         {
             if (auto result = Argument<T>::parse(string)) {
-                *static_cast<std::optional<T>*>(where) = std::move(result);
+                auto& slot = *static_cast<Slot<T>*>(where);
+                slot.value.emplace(
+                    std::make_obj_using_allocator<T>(slot.allocator, std::move(*result)));
                 return true;
             }
             return false;
@@ -96,13 +436,383 @@ namespace cppargs::dtl {
         static auto parse(std::string_view const string, void* const where) -> bool
         {
             if (auto result = Argument<T>::parse(string)) {
-                static_cast<std::vector<T>*>(where)->push_back(std::move(*result));
+                static_cast<std::pmr::vector<T>*>(where)->push_back(std::move(*result));
+                return true;
+            }
+            return false;
+        }
+    };
+
+    template <class T>
+    struct Parse<Sink<T>> {
+        static auto parse(std::string_view const string, void* const where) -> bool
+        {
+            if (auto result = Argument<T>::parse(string)) {
+                static_cast<Sink_slot<T>*>(where)->push(std::move(*result));
+                return true;
+            }
+            return false;
+        }
+    };
+
+    // Converts the run of decimal digits at the start of [begin, end) into `value`. Returns the end
+    // of the run, or null if it is longer than 19 digits and might not fit.
+    [[nodiscard]] auto scan_digits(
+        char const* begin, char const* end, std::uint64_t& value) noexcept -> char const*;
+
+    // Integers parsed by `scan_digits` instead of `Argument<T>::parse`
+    template <class T>
+    concept list_integer = std::integral<T> && sizeof(T) <= sizeof(std::uint64_t)
+                        && !std::same_as<T, bool> && !std::same_as<T, char>;
+
+    template <class T, char separator>
+    auto parse_list(std::string_view string, std::pmr::vector<T>& vector) -> bool
+    {
+        if (string.empty()) {
+            return true;
+        }
+        for (;;) {
+            auto const stop   = string.find(separator);
+            auto       result = Argument<T>::parse(string.substr(0, stop));
+            if (!result.has_value()) {
+                return false;
+            }
+            vector.push_back(std::move(*result));
+            if (stop == std::string_view::npos) {
+                return true;
+            }
+            string.remove_prefix(stop + 1);
+        }
+    }
+
+    template <list_integer T, char separator>
+    auto parse_list(std::string_view const string, std::pmr::vector<T>& vector) -> bool
+    {
+        char const*       it  = string.data();
+        char const* const end = it + string.size();
+        if (it == end) {
+            return true;
+        }
+
+        for (;;) {
+            char const* const element  = it;
+            bool const        negative = std::is_signed_v<T> && *it == '-';
+            it += negative;
+
+            std::uint64_t     magnitude {};
+            char const* const digits_end = scan_digits(it, end, magnitude);
+
+            if (digits_end == it) {
+                return false;
+            }
+            else if (digits_end == nullptr) {
+                // Possibly still valid because of leading zeros
+                auto const found  = std::char_traits<char>::find(
+                    element, static_cast<std::size_t>(end - element), separator);
+                auto const stop   = found != nullptr ? found : end;
+                auto const result = Argument<T>::parse(std::string_view(element, stop));
+                if (!result.has_value()) {
+                    return false;
+                }
+                vector.push_back(*result);
+                it = stop;
+            }
+            else {
+                constexpr auto max = static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+                if (magnitude > max + negative) {
+                    return false;
+                }
+                vector.push_back(static_cast<T>(negative ? 0 - magnitude : magnitude));
+                it = digits_end;
+            }
+
+            if (it == end) {
+                return true;
+            }
+            if (*it != separator || ++it == end) {
+                return false;
+            }
+        }
+    }
+
+    template <class T, char separator>
+    struct Parse<List<T, separator>> {
+        static auto parse(std::string_view const string, void* const where) -> bool
+        {
+            auto&      vector = *static_cast<std::pmr::vector<T>*>(where);
+            auto const size   = vector.size();
+            if (parse_list<T, separator>(string, vector)) {
                 return true;
             }
+            vector.erase(vector.begin() + static_cast<std::ptrdiff_t>(size), vector.end());
             return false;
         }
     };
 
+    template <class T>
+    struct Storage {
+        using Type = Slot<T>;
+
+        static auto reset(Type& slot) -> void
+        {
+            slot.value.reset();
+        }
+
+        static auto has_value(Type const& slot) -> bool
+        {
+            return slot.value.has_value();
+        }
+
+        static auto merge(Type& source, Type& target) -> void
+        {
+            if (source.value.has_value()) {
+                target.value.emplace(
+                    std::make_obj_using_allocator<T>(target.allocator, std::move(*source.value)));
+            }
+        }
+    };
+
+    template <class T>
+    struct Storage<Incremental<T>> {
+        using Type = std::pmr::vector<T>;
+
+        static auto reset(Type& vector) -> void
+        {
+            vector.clear();
+        }
+
+        static auto has_value(Type const& vector) -> bool
+        {
+            return !vector.empty();
+        }
+
+        static auto merge(Type& source, Type& target) -> void
+        {
+            target.insert(
+                target.end(),
+                std::make_move_iterator(source.begin()),
+                std::make_move_iterator(source.end()));
+        }
+    };
+
+    template <class T, char separator>
+    struct Storage<List<T, separator>> : Storage<Incremental<T>> {};
+
+    template <class T>
+    struct Storage<Sink<T>> {
+        using Type = Sink_slot<T>;
+
+        static auto reset(Type& slot) -> void
+        {
+            slot.buffer.clear();
+            slot.count = 0;
+        }
+
+        static auto has_value(Type const& slot) -> bool
+        {
+            return slot.count != 0;
+        }
+
+        // Passes on the values buffered in `source`, in order
+        static auto merge(Type& source, Type& target) -> void
+        {
+            for (auto& value : source.buffer) {
+                target.push(std::move(value));
+            }
+            source.buffer.clear();
+        }
+    };
+
+    // Type-erased operations on the storage of a parameter value
+    struct Value_type {
+        using Construct = auto(void*, std::pmr::memory_resource*) -> void;
+        using Destroy   = auto(void*) -> void;
+        using Reset     = auto(void*) -> void;
+        using Merge     = auto(void* source, void* target) -> void;
+        using Has_value = auto(void const*) -> bool;
+        using Save      = auto(void const*, std::string& output) -> void;
+        using Load      = auto(void*, std::string_view& input) -> bool;
+        Construct* construct {};
+        Destroy*   destroy {};
+        Reset*     reset {};
+        Has_value* has_value {};
+        // Moves the values parsed into `source` into `target`, with the same result as if they
+        // had been parsed into `target` directly
+        Merge*      merge {};
+        std::size_t size {};
+        std::size_t alignment {};
+        // Appends the stored values to `output`, and adds them back from the start of `input`.
+        // Null unless the type of the values is `serializable`.
+        Save* save {};
+        Load* load {};
+        // Identifies the type of the values across builds
+        std::string_view signature;
+        // The only valid arguments, if there is a fixed set of them
+        std::span<std::string_view const> choices;
+    };
+
+    template <class T>
+    struct Value_operations {
+        using Type = typename Storage<T>::Type;
+
+        static auto construct(void* const where, std::pmr::memory_resource* const resource) -> void
+        {
+            std::construct_at(static_cast<Type*>(where), resource);
+        }
+
+        static auto destroy(void* const where) -> void
+        {
+            std::destroy_at(static_cast<Type*>(where));
+        }
+
+        static auto reset(void* const where) -> void
+        {
+            Storage<T>::reset(*static_cast<Type*>(where));
+        }
+
+        static auto merge(void* const source, void* const target) -> void
+        {
+            Storage<T>::merge(*static_cast<Type*>(source), *static_cast<Type*>(target));
+        }
+
+        static auto has_value(void const* const where) -> bool
+        {
+            return Storage<T>::has_value(*static_cast<Type const*>(where));
+        }
+    };
+
+    // The type whose values are stored for a parameter of type `T`
+    template <class T>
+    struct Element {
+        using Type = T;
+    };
+
+    template <class T>
+    struct Element<Incremental<T>> : Element<T> {};
+
+    template <class T, char separator>
+    struct Element<List<T, separator>> : Element<T> {};
+
+    template <class T>
+    struct Element<Sink<T>> : Element<T> {};
+
+    // The name of `T` as spelled by the compiler in the signature of this function. Read only by
+    // `Parse_cache`, so the builtin is used directly rather than through `<source_location>`.
+    template <class T>
+    consteval auto type_signature() -> std::string_view
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return __FUNCSIG__;
+#else
+        return __PRETTY_FUNCTION__;
+#endif
+    }
+
+    // The parameter type whose values are stored by a `Parse_cache` in place of those of `T`, so
+    // that lists share the functions of incremental parameters. Values that were passed on by a
+    // sink cannot be stored, so there is none for sinks.
+    template <class T>
+    struct Cached {
+        using Type = T;
+    };
+
+    template <class T, char separator>
+    struct Cached<List<T, separator>> {
+        using Type = Incremental<T>;
+    };
+
+    template <class T>
+    struct Cached<Sink<T>> {};
+
+    // Append the values stored for a parameter of type `T` to `output`, and add them back from
+    // the start of `input`. Defined in cache.hpp, which argument types with `serialize` and
+    // `deserialize` members must include. The library instantiates them for the built-in types.
+    template <class T>
+    auto save_values(void const* where, std::string& output) -> void;
+
+    template <class T>
+    auto load_values(void* where, std::string_view& input) -> bool;
+
+    // Whether the values of a parameter of type `T` can be stored by a `Parse_cache`
+    template <class T>
+    concept cacheable
+        = serializable<typename Element<T>::Type> && requires { typename Cached<T>::Type; };
+
+    template <class T>
+    consteval auto save_of() -> Value_type::Save*
+    {
+        if constexpr (cacheable<T>) {
+            return save_values<typename Cached<T>::Type>;
+        }
+        else {
+            return nullptr;
+        }
+    }
+
+    template <class T>
+    consteval auto load_of() -> Value_type::Load*
+    {
+        if constexpr (cacheable<T>) {
+            return load_values<typename Cached<T>::Type>;
+        }
+        else {
+            return nullptr;
+        }
+    }
+
+    // `Argument<T>::choices` for the element type of `T`, if there is one
+    template <class T>
+    consteval auto choices_of() -> std::span<std::string_view const>
+    {
+        if constexpr (requires { Argument<typename Element<T>::Type>::choices; }) {
+            return Argument<typename Element<T>::Type>::choices;
+        }
+        else {
+            return {};
+        }
+    }
+
+    template <class T>
+    inline constexpr Value_type value_type_of {
+        .construct = Value_operations<T>::construct,
+        .destroy   = Value_operations<T>::destroy,
+        .reset     = Value_operations<T>::reset,
+        .has_value = Value_operations<T>::has_value,
+        .merge     = Value_operations<T>::merge,
+        .size      = sizeof(typename Value_operations<T>::Type),
+        .alignment = alignof(typename Value_operations<T>::Type),
+        .save      = save_of<T>(),
+        .load      = load_of<T>(),
+        .signature = type_signature<T>(),
+        .choices   = choices_of<T>(),
+    };
+
+    template <class T>
+    auto make_parameter_info(
+        void* const               value,
+        std::optional<char> const short_name,
+        std::string_view const    long_name) -> Parameter_info
+    {
+        return {
+            .parse      = Parse<T>::parse,
+            .value      = value,
+            .value_type = &value_type_of<T>,
+            .long_name  = long_name,
+            .short_name = short_name,
+            .is_flag    = std::is_same_v<T, Unit>,
+        };
+    }
+
+    template <class T>
+    auto make_parameter_help(std::string_view const description) -> Parameter_help
+    {
+        return {
+            .type_name   = type_name<T>(),
+            .description = description,
+            .complete    = Completion<T>::value,
+        };
+    }
+
     template <class T>
     concept has_parse = requires(std::string_view const view) {
         // clang-format off
@@ -116,6 +826,33 @@ namespace cppargs::dtl {
     template <class T>
     struct Is_argument<Incremental<T>> : Is_argument<T> {};
 
+    template <class T, char separator>
+    struct Is_argument<List<T, separator>> : Is_argument<T> {};
+
+    // Whether a positional parameter of type `T` takes all remaining arguments
+    template <class T>
+    struct Is_variadic : std::false_type {};
+
+    template <class T>
+    struct Is_variadic<Incremental<T>> : std::true_type {};
+
+    // Parameter that takes the command line arguments after `--`
+    struct Trailing_info {
+        Command_line*    value {};
+        std::string_view name;
+        std::string_view description;
+    };
+
+    // Positional parameters, in order. Required ones come first, and the last one may be
+    // variadic.
+    struct Positional_parameters {
+        std::span<Parameter_info const> infos;
+        std::span<Parameter_help const> helps;
+        std::size_t                     required {};
+        bool                            variadic {};
+        Command_line*                   trailing {};
+    };
+
 } // namespace cppargs::dtl
 
 namespace cppargs {
@@ -125,17 +862,24 @@ namespace cppargs {
 
     template <class T>
     class Parameter {
-        std::unique_ptr<std::optional<T>> m_value = std::make_unique<std::optional<T>>();
+        dtl::Resource_ptr<dtl::Slot<T>> m_value;
+
+        explicit Parameter(std::pmr::memory_resource* const resource)
+            : m_value(dtl::make_resource_ptr<dtl::Slot<T>>(resource, resource))
+        {}
+
         friend class Parameters;
     public:
+        Parameter() : Parameter(std::pmr::get_default_resource()) {}
+
         [[nodiscard]] auto value() const noexcept -> T const&
         {
-            return m_value->value();
+            return m_value->value.value();
         }
 
         [[nodiscard]] auto has_value() const noexcept -> bool
         {
-            return m_value->has_value();
+            return m_value->value.has_value();
         }
 
         [[nodiscard]] explicit operator bool() const noexcept
@@ -146,9 +890,39 @@ namespace cppargs {
 
     template <class T>
     class Parameter<Incremental<T>> {
-        std::unique_ptr<std::vector<T>> m_value = std::make_unique<std::vector<T>>();
+        dtl::Resource_ptr<std::pmr::vector<T>> m_value;
+
+        explicit Parameter(std::pmr::memory_resource* const resource)
+            : m_value(dtl::make_resource_ptr<std::pmr::vector<T>>(resource))
+        {}
+
+        friend class Parameters;
+    public:
+        Parameter() : Parameter(std::pmr::get_default_resource()) {}
+
+        [[nodiscard]] auto values() const noexcept -> std::span<T const>
+        {
+            return *m_value;
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept
+        {
+            return !values().empty();
+        }
+    };
+
+    template <class T, char separator>
+    class Parameter<List<T, separator>> {
+        dtl::Resource_ptr<std::pmr::vector<T>> m_value;
+
+        explicit Parameter(std::pmr::memory_resource* const resource)
+            : m_value(dtl::make_resource_ptr<std::pmr::vector<T>>(resource))
+        {}
+
         friend class Parameters;
     public:
+        Parameter() : Parameter(std::pmr::get_default_resource()) {}
+
         [[nodiscard]] auto values() const noexcept -> std::span<T const>
         {
             return *m_value;
@@ -160,30 +934,188 @@ namespace cppargs {
         }
     };
 
+    template <class T>
+    class Parameter<Sink<T>> {
+        dtl::Resource_ptr<dtl::Sink_slot<T>> m_value;
+
+        Parameter(
+            std::pmr::memory_resource* const resource, std::function<auto(T)->void> consume)
+            : m_value(
+                  dtl::make_resource_ptr<dtl::Sink_slot<T>>(resource, resource, std::move(consume)))
+        {}
+
+        friend class Parameters;
+    public:
+        Parameter() : Parameter(std::pmr::get_default_resource(), {}) {}
+
+        // The number of values passed on so far
+        [[nodiscard]] auto count() const noexcept -> std::size_t
+        {
+            return m_value->count;
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept
+        {
+            return count() != 0;
+        }
+    };
+
+    // Arguments after `--` on the command line. They are not parsed, and refer into the command
+    // line.
+    class Trailing_arguments {
+        dtl::Resource_ptr<Command_line> m_value;
+
+        explicit Trailing_arguments(std::pmr::memory_resource* const resource)
+            : m_value(dtl::make_resource_ptr<Command_line>(resource))
+        {}
+
+        friend class Parameters;
+    public:
+        Trailing_arguments() : Trailing_arguments(std::pmr::get_default_resource()) {}
+
+        [[nodiscard]] auto arguments() const noexcept -> Command_line
+        {
+            return *m_value;
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept
+        {
+            return !arguments().empty();
+        }
+    };
+
+    enum class Presence : std::uint8_t { required, optional };
+
+    // All parameter values, as well as the parameter table itself, are allocated from the memory
+    // resource given on construction. A `std::pmr::monotonic_buffer_resource` keeps every value of
+    // a schema in one contiguous arena. The resource must outlive the `Parameter` handles.
     class Parameters {
-        std::vector<dtl::Parameter_info> m_vector;
+        std::pmr::memory_resource*                             m_resource;
+        std::pmr::vector<dtl::Parameter_info>                  m_vector;
+        std::pmr::vector<dtl::Parameter_help>                  m_help;
+        std::pmr::unordered_map<std::string_view, std::size_t> m_long_index;
+        dtl::Sorted_names_ptr                                  m_sorted_names;
+        std::array<std::uint32_t, 256>                         m_short_index {}; // Index plus one
+        bool                                                   m_abbreviations {};
+
+        using Environment_index = std::pmr::
+            unordered_map<std::pmr::string, std::size_t, dtl::String_hash, std::equal_to<>>;
+
+        std::optional<std::pmr::string> m_environment_prefix;
+        Environment_index               m_environment_index;
+        std::size_t                     m_help_names_width {}; // Kept up to date by `push`
+
+        std::pmr::vector<dtl::Parameter_info> m_positionals;
+        std::pmr::vector<dtl::Parameter_help> m_positional_help;
+        std::size_t                           m_required_positionals {};
+        bool                                  m_variadic_positional {};
+        dtl::Trailing_info                    m_trailing;
+
+        auto push(dtl::Parameter_info const& info, dtl::Parameter_help const& help) -> void;
+        auto push_positional(
+            dtl::Parameter_info const& info,
+            dtl::Parameter_help const& help,
+            Presence                   presence,
+            bool                       variadic) -> void;
+        auto write_help(dtl::Help_writer writer, std::size_t width) const -> void;
+        friend class Schema;
     public:
+        Parameters() : Parameters(std::pmr::get_default_resource()) {}
+
+        explicit Parameters(std::pmr::memory_resource* resource);
+
+        [[nodiscard]] auto resource() const noexcept -> std::pmr::memory_resource*;
         [[nodiscard]] auto help_string() const -> std::string;
+
+        // Writes the help text without allocating. With a nonzero `width`, descriptions are
+        // wrapped at spaces to fit lines in `width` columns, counting the leading tab as 8.
+        // Without wrapping, the text is the same as `help_string`.
+        template <std::output_iterator<char> Output>
+        auto help_to(Output output, std::size_t const width = 0) const -> Output
+        {
+            auto const write = [](void* const context, std::string_view const text) {
+                auto& output = *static_cast<Output*>(context);
+                for (char const character : text) {
+                    *output++ = character;
+                }
+            };
+            write_help({ .write = write, .context = &output }, width);
+            return output;
+        }
+
+        auto help_to(std::FILE* file, std::size_t width = 0) const -> void;
+
         [[nodiscard]] auto info_span() const noexcept -> std::span<dtl::Parameter_info const>;
 
+        // Help metadata of the parameters, in the same order as `info_span`
+        [[nodiscard]] auto help_span() const noexcept -> std::span<dtl::Parameter_help const>;
+
+        // The help metadata of `info`, which must be an element of `info_span`
+        [[nodiscard]] auto help_of(dtl::Parameter_info const& info) const noexcept
+            -> dtl::Parameter_help const&;
+
+        // Constant time lookup, independent of the number of parameters
+        [[nodiscard]] auto find(std::string_view long_name) const -> dtl::Parameter_info const*;
+        [[nodiscard]] auto find(char short_name) const noexcept -> dtl::Parameter_info const*;
+
+        // The long names in sorted order, without duplicates. Sorted on first use.
+        [[nodiscard]] auto long_names() const -> std::span<std::string_view const>;
+
+        // Lets long options be abbreviated to any prefix that no other long name starts with, so
+        // that `--verb` is taken as `--verbose`. Exact names always take precedence.
+        auto allow_abbreviations(bool allow = true) -> void;
+
+        // The parameter named `long_name` on the command line: one found by `find`, or the only
+        // one whose long name starts with `long_name` if abbreviations are allowed. Only falls
+        // back to the sorted index of long names when there is no exact match.
+        [[nodiscard]] auto match(std::string_view long_name) const -> dtl::Parameter_info const*;
+
+        // Up to `count` long names that `name` was probably meant to be, closest first. If
+        // abbreviations are allowed and `name` is an ambiguous one, these are the names it
+        // abbreviates. Takes microseconds even for thousands of parameters.
+        [[nodiscard]] auto suggest(std::string_view name, std::size_t count = 3) const
+            -> std::vector<std::string_view>;
+
+        // Reads parameters from environment variables named `prefix` followed by the long name in
+        // upper case, with dashes replaced by underscores: `--max-size` is read from
+        // `APP_MAX_SIZE` with the prefix `APP_`. Variable names are mapped back by lowering the
+        // case and replacing underscores, so long names with upper case letters or underscores
+        // are not reached this way; bind them with `set_environment_variable` instead.
+        auto set_environment_prefix(std::string_view prefix) -> void;
+
+        // Reads the parameter with the given long name from `variable`, in addition to any name
+        // derived from the prefix. Throws `std::invalid_argument` if there is no such parameter.
+        auto set_environment_variable(std::string_view long_name, std::string_view variable)
+            -> void;
+
+        // The parameter read from the environment variable `name`, or null
+        [[nodiscard]] auto find_environment(std::string_view name) const
+            -> dtl::Parameter_info const*;
+
+        [[nodiscard]] auto uses_environment() const noexcept -> bool;
+
+        // Adds a parameter that takes an argument that is not an option. Positional parameters
+        // take arguments in the order they are added; an incremental one takes all remaining
+        // arguments. Throws `std::invalid_argument` if a parameter is added after an incremental
+        // one, or if a required parameter is added after an optional one.
+        template <argument T>
+        [[nodiscard]] auto add_positional(
+            std::string_view name,
+            std::string_view description = {},
+            Presence         presence    = Presence::required) -> Parameter<T>;
+
+        // Takes the command line arguments after `--` without parsing them. Without this, they
+        // are taken by positional parameters. Throws `std::invalid_argument` if called twice.
+        [[nodiscard]] auto add_trailing(
+            std::string_view name, std::string_view description = {}) -> Trailing_arguments;
+
+        [[nodiscard]] auto positional_parameters() const noexcept -> dtl::Positional_parameters;
+
         template <argument T = Unit>
         [[nodiscard]] auto add(
-            std::optional<char> const short_name,
-            std::string_view const    long_name,
-            std::string_view const    description = {}) -> Parameter<T>
-        {
-            Parameter<T> parameter;
-            m_vector.push_back({
-                .parse       = dtl::Parse<T>::parse,
-                .value       = parameter.m_value.get(),
-                .is_flag     = std::is_same_v<T, Unit>,
-                .type_name   = dtl::type_name<T>(),
-                .long_name   = long_name,
-                .short_name  = short_name,
-                .description = description,
-            });
-            return parameter;
-        }
+            std::optional<char> short_name,
+            std::string_view    long_name,
+            std::string_view    description = {}) -> Parameter<T>;
 
         template <argument T = Unit>
         [[nodiscard]] auto add(
@@ -192,20 +1124,154 @@ namespace cppargs {
         {
             return add<T>(std::nullopt, long_name, description);
         }
+
+        // Adds an option whose values are passed to `consume` as soon as they are parsed, in
+        // command line order, instead of being kept until parsing ends. Values passed on before
+        // a parse error are not taken back, and exceptions thrown by `consume` propagate out of
+        // parsing. `parse_parallel` converts the values on other threads, but still passes them
+        // on from the calling thread, in order, once they are all converted. Sinks are never
+        // restored from a `Parse_cache`.
+        template <argument T>
+        [[nodiscard]] auto add_sink(
+            std::optional<char>          short_name,
+            std::string_view             long_name,
+            std::string_view             description,
+            std::function<auto(T)->void> consume) -> Parameter<Sink<T>>;
+
+        template <argument T>
+        [[nodiscard]] auto add_sink(
+            std::string_view const       long_name,
+            std::string_view const       description,
+            std::function<auto(T)->void> consume) -> Parameter<Sink<T>>
+        {
+            return add_sink<T>(std::nullopt, long_name, description, std::move(consume));
+        }
     };
 
     auto parse(Command_line command_line, Parameters const& parameters) -> void;
 
     auto parse(int argc, char const* const* argv, Parameters const& parameters) -> void;
 
+    // Like `parse`, but returns the error instead of throwing
+    [[nodiscard]] auto try_parse(Command_line command_line, Parameters const& parameters)
+        -> std::optional<Parse_error>;
+
+    [[nodiscard]] auto try_parse(int argc, char const* const* argv, Parameters const& parameters)
+        -> std::optional<Parse_error>;
+
+    // Expands `@file` arguments using `response_files`
+    auto parse(
+        Command_line      command_line,
+        Parameters const& parameters,
+        Response_files&   response_files) -> void;
+
+    [[nodiscard]] auto try_parse(
+        Command_line      command_line,
+        Parameters const& parameters,
+        Response_files&   response_files) -> std::optional<Parse_error>;
+
+    // The environment of the current process
+    [[nodiscard]] auto process_environment() noexcept -> Environment;
+
+    // Sets parameters that do not have a value yet from the environment variables they are bound
+    // to with `Parameters::set_environment_prefix` or `Parameters::set_environment_variable`.
+    // Flags are set by values such as `1` or `true`. The command line of an error is the
+    // offending `NAME=value` string. `parse` calls this with the process environment after the
+    // command line, if any environment variables are bound.
+    [[nodiscard]] auto try_parse_environment(Environment environment, Parameters const& parameters)
+        -> std::optional<Parse_error>;
+
+    auto parse_environment(Environment environment, Parameters const& parameters) -> void;
+
+    // Sets parameters that do not have a value yet from a configuration file, usually one mapped
+    // with `Response_files::open`. Each line is a `key = value` pair, a `[section]` header, or a
+    // comment starting with `#` or `;`. Keys are long names; within a section, the key is
+    // prefixed by the section name and a dash, so `size` in `[cache]` sets `--cache-size`.
+    // Values may be surrounded by double quotes to keep surrounding whitespace, and refer into
+    // the file text. A flag may be given without a value. Repeated keys append to incremental
+    // parameters. Apply sources in order of decreasing precedence, starting with the command
+    // line. Errors refer to the file, line, and column.
+    [[nodiscard]] auto try_parse_config(Source_file const& file, Parameters const& parameters)
+        -> std::optional<Parse_error>;
+
+    auto parse_config(Source_file const& file, Parameters const& parameters) -> void;
+
+    // Scans the whole command line first, then converts the values on `thread_count` threads, or
+    // on one per hardware thread if it is zero. Worthwhile for very long command lines or costly
+    // `Argument<T>::parse` implementations, which must be safe to call concurrently. The result
+    // is the same as with `parse`: incremental values keep their order, and the error closest to
+    // the start of the command line is reported.
+    auto parse_parallel(
+        Command_line      command_line,
+        Parameters const& parameters,
+        std::size_t       thread_count = 0) -> void;
+
+    [[nodiscard]] auto try_parse_parallel(
+        Command_line      command_line,
+        Parameters const& parameters,
+        std::size_t       thread_count = 0) -> std::optional<Parse_error>;
+
+    // Parses the arguments of `command_string`. Error columns refer to the original string.
+    auto parse(Command_string const& command_string, Parameters const& parameters) -> void;
+
+    [[nodiscard]] auto try_parse(Command_string const& command_string, Parameters const& parameters)
+        -> std::optional<Parse_error>;
+
 } // namespace cppargs
 
+// Not defined in the class, so that the declarations below keep translation units from
+// instantiating the parsing and storage templates behind them for the built-in types.
+template <cppargs::argument T>
+auto cppargs::Parameters::add(
+    std::optional<char> const short_name,
+    std::string_view const    long_name,
+    std::string_view const    description) -> Parameter<T>
+{
+    Parameter<T> parameter(m_resource);
+    push(
+        dtl::make_parameter_info<T>(parameter.m_value.get(), short_name, long_name),
+        dtl::make_parameter_help<T>(description));
+    return parameter;
+}
+
+template <cppargs::argument T>
+auto cppargs::Parameters::add_positional(
+    std::string_view const name,
+    std::string_view const description,
+    Presence const         presence) -> Parameter<T>
+{
+    Parameter<T> parameter(m_resource);
+    push_positional(
+        dtl::make_parameter_info<T>(parameter.m_value.get(), std::nullopt, name),
+        dtl::make_parameter_help<T>(description),
+        presence,
+        dtl::Is_variadic<T>::value);
+    return parameter;
+}
+
+template <cppargs::argument T>
+auto cppargs::Parameters::add_sink(
+    std::optional<char> const    short_name,
+    std::string_view const       long_name,
+    std::string_view const       description,
+    std::function<auto(T)->void> consume) -> Parameter<Sink<T>>
+{
+    Parameter<Sink<T>> parameter(m_resource, std::move(consume));
+    push(
+        dtl::make_parameter_info<Sink<T>>(parameter.m_value.get(), short_name, long_name),
+        dtl::make_parameter_help<T>(description));
+    return parameter;
+}
+
 template <>
 struct cppargs::Argument<cppargs::Unit> {
     static auto parse(std::string_view) -> std::optional<Unit>
     {
         return Unit {};
     }
+
+    static auto serialize(Unit, std::string& output) -> void;
+    static auto deserialize(std::string_view& input) -> std::optional<Unit>;
 };
 
 template <>
@@ -215,6 +1281,11 @@ struct cppargs::Argument<std::string_view> {
         return view;
     }
 
+    static auto serialize(std::string_view const& value, std::string& output) -> void;
+
+    // Refers into `input`, which a `Parse_cache` keeps mapped
+    static auto deserialize(std::string_view& input) -> std::optional<std::string_view>;
+
     static constexpr std::string_view type_name = "str";
 };
 
@@ -225,6 +1296,22 @@ struct cppargs::Argument<std::string> {
         return std::string(view);
     }
 
+    static auto serialize(std::string const& value, std::string& output) -> void;
+    static auto deserialize(std::string_view& input) -> std::optional<std::string>;
+
+    static constexpr std::string_view type_name = "str";
+};
+
+template <>
+struct cppargs::Argument<std::pmr::string> {
+    static auto parse(std::string_view const view) -> std::optional<std::pmr::string>
+    {
+        return std::pmr::string(view);
+    }
+
+    static auto serialize(std::pmr::string const& value, std::string& output) -> void;
+    static auto deserialize(std::string_view& input) -> std::optional<std::pmr::string>;
+
     static constexpr std::string_view type_name = "str";
 };
 
@@ -240,6 +1327,9 @@ struct cppargs::Argument<char> {
         }
     }
 
+    static auto serialize(char value, std::string& output) -> void;
+    static auto deserialize(std::string_view& input) -> std::optional<char>;
+
     static constexpr std::string_view type_name = "char";
 };
 
@@ -258,6 +1348,14 @@ struct cppargs::Argument<bool> {
         }
     }
 
+    static auto complete(std::string_view) -> std::vector<std::string>
+    {
+        return { "true", "false", "yes", "no", "on", "off" };
+    }
+
+    static auto serialize(bool value, std::string& output) -> void;
+    static auto deserialize(std::string_view& input) -> std::optional<bool>;
+
     static constexpr std::string_view type_name = "bool";
 };
 
@@ -279,5 +1377,49 @@ struct cppargs::Argument<T> {
         }
     }
 
+    // Defined in cache.hpp
+    static auto serialize(T value, std::string& output) -> void;
+    static auto deserialize(std::string_view& input) -> std::optional<T>;
+
     static constexpr std::string_view type_name = "int";
 };
+
+// The parameters of the built-in argument types are added by functions instantiated once, in
+// instantiations.cpp, instead of in every translation unit that adds such parameters. Define
+// `CPPARGS_NO_EXTERN_TEMPLATES` to instantiate them in each translation unit instead.
+#define CPPARGS_DTL_FOR_EACH_INTEGER(X) \
+    X(signed char)                      \
+    X(unsigned char)                    \
+    X(short)                            \
+    X(unsigned short)                   \
+    X(int)                              \
+    X(unsigned int)                     \
+    X(long)                             \
+    X(unsigned long)                    \
+    X(long long)                        \
+    X(unsigned long long)
+
+// Argument types that are also instantiated as `Incremental`, which excludes `bool`
+#define CPPARGS_DTL_FOR_EACH_ARGUMENT(X) \
+    CPPARGS_DTL_FOR_EACH_INTEGER(X)      \
+    X(cppargs::Unit)                     \
+    X(char)                              \
+    X(std::string)                       \
+    X(std::string_view)
+
+// `prefix` is either `extern` or empty
+#define CPPARGS_DTL_INSTANTIATE(prefix, T)                                   \
+    prefix template auto cppargs::Parameters::add<T>(                        \
+        std::optional<char>, std::string_view, std::string_view)             \
+        -> cppargs::Parameter<T>;                                            \
+    prefix template auto cppargs::Parameters::add_positional<T>(             \
+        std::string_view, std::string_view, cppargs::Presence)               \
+        -> cppargs::Parameter<T>;
+
+#define CPPARGS_DTL_EXTERN_ARGUMENT(T) \
+    CPPARGS_DTL_INSTANTIATE(extern, T) CPPARGS_DTL_INSTANTIATE(extern, cppargs::Incremental<T>)
+
+#ifndef CPPARGS_NO_EXTERN_TEMPLATES
+CPPARGS_DTL_FOR_EACH_ARGUMENT(CPPARGS_DTL_EXTERN_ARGUMENT)
+CPPARGS_DTL_INSTANTIATE(extern, bool)
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cppargs.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cppargs {
+
+    // Errors recorded by `parse_all`. Each error refers to the command line or file it was found
+    // in rather than copying it, so the command line, response files, and command strings must
+    // outlive the diagnostics. Messages are only rendered on request.
+    class Diagnostics {
+        std::vector<Parse_error>              m_errors;
+        std::vector<std::vector<std::string>> m_suggestions; // Of each error, closest first
+    public:
+        // `suggestions` are the names that an unrecognized option was probably meant to be
+        auto add(Parse_error const& error, std::span<std::string_view const> suggestions = {})
+            -> void;
+        auto clear() noexcept -> void;
+
+        [[nodiscard]] auto errors() const noexcept -> std::span<Parse_error const>;
+        [[nodiscard]] auto empty() const noexcept -> bool;
+
+        // The suggestions added with the error at `index` of `errors()`
+        [[nodiscard]] auto suggestions(std::size_t index) const -> std::span<std::string const>;
+
+        // Renders every error at once. Each line of input containing errors is shown once,
+        // followed by one line per error that marks it and gives the message.
+        [[nodiscard]] auto render() const -> std::string;
+    };
+
+    // Like `try_parse`, but keeps parsing after errors and records every one of them in
+    // `diagnostics`. An erroneous argument is skipped, and so is an argument after an
+    // unrecognized option that cannot be taken as a positional argument, as it is probably the
+    // value of that option. An unreadable or recursive response file ends the parse. Returns
+    // whether there were no errors.
+    [[nodiscard]] auto parse_all(
+        Command_line command_line, Parameters const& parameters, Diagnostics& diagnostics)
+        -> bool;
+
+    [[nodiscard]] auto parse_all(
+        Command_line      command_line,
+        Parameters const& parameters,
+        Response_files&   response_files,
+        Diagnostics&      diagnostics) -> bool;
+
+} // namespace cppargs
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <cppargs.hpp>
+#include <cache.hpp>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace cppargs {
+
+    enum class Case : std::uint8_t { sensitive, insensitive };
+
+    template <class E>
+    struct Enum_name {
+        std::string_view name;
+        E                value {};
+    };
+
+    // Names of the values of an enumeration, made by `enum_names`
+    template <class E, std::size_t size>
+    struct Enum_names {
+        std::string_view               type_name;
+        std::array<Enum_name<E>, size> names;
+        Case                           name_case {};
+    };
+
+    // Names of the values of `E`, for `Enum_argument`. `type_name` is shown in help text. With
+    // `Case::insensitive`, names are matched regardless of the case of ASCII letters.
+    template <class E, std::size_t size>
+        requires std::is_enum_v<E>
+    consteval auto enum_names(
+        std::string_view const type_name,
+        Enum_name<E> const (&names)[size],
+        Case const name_case = Case::sensitive) -> Enum_names<E, size>
+    {
+        Enum_names<E, size> result { .type_name = type_name, .names = {}, .name_case = name_case };
+        std::copy_n(names, size, result.names.begin());
+        return result;
+    }
+
+} // namespace cppargs
+
+namespace cppargs::dtl {
+
+    [[nodiscard]] constexpr auto fold_case(char const character, Case const name_case) noexcept
+        -> char
+    {
+        return name_case == Case::insensitive && character >= 'A' && character <= 'Z'
+                 ? static_cast<char>(character - 'A' + 'a')
+                 : character;
+    }
+
+    [[nodiscard]] constexpr auto equal_names(
+        std::string_view const a, std::string_view const b, Case const name_case) noexcept -> bool
+    {
+        auto const fold = [](char const character) {
+            return fold_case(character, Case::insensitive);
+        };
+        return name_case == Case::sensitive ? a == b : std::ranges::equal(a, b, {}, fold, fold);
+    }
+
+    // Finalizer of MurmurHash3, so that every bit of the result depends on every bit of `hash`
+    [[nodiscard]] constexpr auto mix_hash(std::uint64_t hash) noexcept -> std::uint64_t
+    {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccd;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    // FNV-1a of the case-folded name. The upper bits of FNV-1a barely change between names that
+    // differ only in their last characters, so the result is mixed before it is used for buckets.
+    [[nodiscard]] constexpr auto hash_name(
+        std::string_view const name, Case const name_case) noexcept -> std::uint64_t
+    {
+        std::uint64_t hash = 0xcbf29ce484222325;
+        for (char const character : name) {
+            hash ^= static_cast<unsigned char>(fold_case(character, name_case));
+            hash *= 0x100000001b3;
+        }
+        return mix_hash(hash);
+    }
+
+    // Perfect hash of `size` distinct hashes, at least one, built at compile time by hash and
+    // displace. The hashes are grouped into buckets by their upper half, and each bucket, largest
+    // first, gets the first displacement that sends all of its hashes to free slots. A lookup
+    // computes one slot, which holds the index of the only name that can match.
+    template <std::size_t size>
+    class Perfect_hash {
+        static_assert(size != 0, "cppargs::Perfect_hash: No hashes");
+
+        static constexpr std::size_t   bucket_count = (size + 1) / 2;
+        static constexpr std::size_t   slot_count   = std::bit_ceil(size + size / 2);
+        static constexpr std::uint32_t empty        = size;
+
+        std::array<std::uint32_t, bucket_count> m_displacements {};
+        std::array<std::uint32_t, slot_count>   m_slots {};
+
+        [[nodiscard]] static constexpr auto bucket(std::uint64_t const hash) noexcept
+            -> std::size_t
+        {
+            return static_cast<std::size_t>(((hash >> 32) * bucket_count) >> 32);
+        }
+
+        [[nodiscard]] static constexpr auto slot(
+            std::uint64_t const hash, std::uint32_t const displacement) noexcept -> std::size_t
+        {
+            return static_cast<std::size_t>(
+                mix_hash(hash + displacement * 0x9e3779b97f4a7c15) & (slot_count - 1));
+        }
+    public:
+        // Throws `std::invalid_argument`, which fails compilation, if two hashes are equal
+        consteval explicit Perfect_hash(std::array<std::uint64_t, size> const& hashes)
+        {
+            // Indices of the hashes, grouped by bucket
+            std::array<std::size_t, bucket_count + 1> starts {};
+            for (auto const hash : hashes) {
+                ++starts[bucket(hash) + 1];
+            }
+            for (std::size_t index = 0; index != bucket_count; ++index) {
+                starts[index + 1] += starts[index];
+            }
+            std::array<std::uint32_t, size> members {};
+            auto                            ends = starts;
+            for (std::size_t index = 0; index != size; ++index) {
+                members[ends[bucket(hashes[index])]++] = static_cast<std::uint32_t>(index);
+            }
+
+            std::array<std::size_t, bucket_count> order {};
+            for (std::size_t index = 0; index != bucket_count; ++index) {
+                order[index] = index;
+            }
+            auto const bucket_size = [&](std::size_t const index) {
+                return starts[index + 1] - starts[index];
+            };
+            std::ranges::sort(order, [&](std::size_t const a, std::size_t const b) {
+                return bucket_size(a) != bucket_size(b) ? bucket_size(a) > bucket_size(b) : a < b;
+            });
+
+            m_slots.fill(empty);
+            for (auto const index : order) {
+                std::span const bucket_members(
+                    members.begin() + starts[index], members.begin() + starts[index + 1]);
+                for (std::uint32_t displacement = 0;; ++displacement) {
+                    if (displacement == 1 << 20) {
+                        throw std::invalid_argument { "cppargs::Perfect_hash: Equal hashes" };
+                    }
+                    auto const is_free = [&](std::size_t const count) {
+                        auto const current = slot(hashes[bucket_members[count]], displacement);
+                        return m_slots[current] == empty
+                            && std::ranges::none_of(
+                                   bucket_members.first(count), [&](std::uint32_t const other) {
+                                       return slot(hashes[other], displacement) == current;
+                                   });
+                    };
+                    std::size_t count = 0;
+                    while (count != bucket_members.size() && is_free(count)) {
+                        ++count;
+                    }
+                    if (count == bucket_members.size()) {
+                        for (auto const member : bucket_members) {
+                            m_slots[slot(hashes[member], displacement)] = member;
+                        }
+                        m_displacements[index] = displacement;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // The index of the only hash that may be `hash`, or `size` if there is none
+        [[nodiscard]] constexpr auto find(std::uint64_t const hash) const noexcept -> std::size_t
+        {
+            return m_slots[slot(hash, m_displacements[bucket(hash)])];
+        }
+    };
+
+} // namespace cppargs::dtl
+
+namespace cppargs {
+
+    // Base for `Argument<E>` that parses the names in `names`, which must be made by
+    // `enum_names` and have static storage duration. Names are looked up with a perfect hash
+    // computed at compile time, so parsing takes the same time for any number of names. The
+    // names are listed in help text, offered as completions, and suggested for invalid arguments.
+    //
+    //     inline constexpr auto color_names = cppargs::enum_names<Color>(
+    //         "color", { { "red", Color::red }, { "green", Color::green } });
+    //
+    //     template <>
+    //     struct cppargs::Argument<Color> : cppargs::Enum_argument<color_names> {};
+    template <auto const& names>
+    struct Enum_argument {
+    private:
+        using Enum = decltype(names.names.front().value);
+
+        static constexpr std::size_t size = names.names.size();
+
+        static_assert(size != 0, "cppargs::Enum_argument: No names");
+
+        // Equal names have equal hashes, and different ones practically never do.
+        static constexpr auto hashes = [] {
+            std::array<std::uint64_t, size> hashes {};
+            for (std::size_t index = 0; index != size; ++index) {
+                hashes[index] = dtl::hash_name(names.names[index].name, names.name_case);
+            }
+            auto sorted = hashes;
+            std::ranges::sort(sorted);
+            if (std::ranges::adjacent_find(sorted) != sorted.end()) {
+                throw std::invalid_argument { "cppargs::Enum_argument: Duplicate name" };
+            }
+            return hashes;
+        }();
+
+        static constexpr dtl::Perfect_hash<size> hash { hashes };
+
+        static constexpr auto name_array = [] {
+            std::array<std::string_view, size> array;
+            std::ranges::transform(names.names, array.begin(), &Enum_name<Enum>::name);
+            return array;
+        }();
+    public:
+        static constexpr std::span<std::string_view const> choices = name_array;
+
+        static constexpr std::string_view type_name = names.type_name;
+
+        static auto parse(std::string_view const view) -> std::optional<Enum>
+        {
+            auto const index = hash.find(dtl::hash_name(view, names.name_case));
+            if (index != size && dtl::equal_names(names.names[index].name, view, names.name_case)) {
+                return names.names[index].value;
+            }
+            return std::nullopt;
+        }
+
+        static auto complete(std::string_view const prefix) -> std::vector<std::string>
+        {
+            std::vector<std::string> completions;
+            for (auto const name : choices) {
+                // Matched like `parse` does, so `RE` completes to `red` regardless of case
+                if (name.size() >= prefix.size()
+                    && dtl::equal_names(name.substr(0, prefix.size()), prefix, names.name_case))
+                {
+                    completions.emplace_back(name);
+                }
+            }
+            return completions;
+        }
+
+        static auto serialize(Enum const value, std::string& output) -> void
+        {
+            dtl::serialize_bytes(value, output);
+        }
+
+        // Only values with a name are accepted.
+        static auto deserialize(std::string_view& input) -> std::optional<Enum>
+        {
+            auto const value = dtl::deserialize_bytes<Enum>(input);
+            if (value.has_value()
+                && std::ranges::find(names.names, value.value(), &Enum_name<Enum>::value)
+                       != names.names.end())
+            {
+                return value;
+            }
+            return std::nullopt;
+        }
+    };
+
+} // namespace cppargs
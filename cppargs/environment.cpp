@@ -0,0 +1,63 @@
+#include <cppargs.hpp>
+
+#if defined(_WIN32)
+#include <stdlib.h>
+#define CPPARGS_ENVIRON _environ
+#else
+extern "C" char** environ;
+#define CPPARGS_ENVIRON environ
+#endif
+
+auto cppargs::process_environment() noexcept -> Environment
+{
+    char** const variables = CPPARGS_ENVIRON;
+    if (variables == nullptr) {
+        return {};
+    }
+    std::size_t size = 0;
+    while (variables[size] != nullptr) {
+        ++size;
+    }
+    return Environment(variables, size);
+}
+
+auto cppargs::try_parse_environment(Environment const environment, Parameters const& parameters)
+    -> std::optional<Parse_error>
+{
+    // One lookup per variable, so the cost does not depend on the number of parameters
+    for (std::size_t index = 0; index != environment.size(); ++index) {
+        if (environment[index] == nullptr) {
+            continue;
+        }
+        std::string_view const variable = environment[index];
+
+        auto const equals = variable.find('=');
+        if (equals == std::string_view::npos) {
+            continue;
+        }
+        auto const info = parameters.find_environment(variable.substr(0, equals));
+        if (info == nullptr || info->value_type->has_value(info->value)) {
+            continue;
+        }
+
+        auto const value = variable.substr(equals + 1);
+        if (!dtl::parse_setting(*info, value)) {
+            return Parse_error(
+                environment.subspan(index, 1),
+                0,
+                Parse_error_info::Kind::invalid_argument,
+                value,
+                nullptr,
+                info->value_type->choices);
+        }
+    }
+    return std::nullopt;
+}
+
+auto cppargs::parse_environment(Environment const environment, Parameters const& parameters)
+    -> void
+{
+    if (auto const error = try_parse_environment(environment, parameters)) {
+        throw Exception(error.value());
+    }
+}
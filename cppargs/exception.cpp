@@ -1,7 +1,90 @@
 #include <cppargs.hpp>
+#include <diagnostics.hpp>
+#include <suggestions.hpp>
+#include <algorithm>
 #include <format>
 
 namespace {
+    [[nodiscard]] auto make_command_line_string(cppargs::Command_line const command_line)
+        -> std::string
+    {
+        std::string line = command_line.front() == nullptr ? "" : command_line.front();
+        std::for_each(
+            command_line.begin() + 1, command_line.end(), [&line](char const* const string) {
+                line.append(1, ' ').append(string);
+            });
+        return line;
+    }
+
+    // Offset of the beginning of the line containing `offset`
+    [[nodiscard]] auto line_offset(std::string_view const text, std::size_t const offset)
+        -> std::size_t
+    {
+        auto const newline = text.substr(0, offset).rfind('\n');
+        return newline == std::string_view::npos ? 0 : newline + 1;
+    }
+
+    // Offset of `view` in the text of `file`, or else in the argument at index `argument`. A null
+    // `argv[0]` has no text to point into, so an error there is at its start.
+    [[nodiscard]] auto error_offset(
+        cppargs::Command_line const       command_line,
+        std::size_t const                 argument,
+        std::string_view const            view,
+        cppargs::Source_file const* const file) noexcept -> std::size_t
+    {
+        if (file != nullptr) {
+            return static_cast<std::size_t>(view.data() - file->text.data());
+        }
+        if (argument < command_line.size() && command_line[argument] != nullptr) {
+            return static_cast<std::size_t>(view.data() - command_line[argument]);
+        }
+        return 0;
+    }
+
+    [[nodiscard]] auto command_line_column(
+        cppargs::Command_line::iterator const begin, cppargs::Command_line::iterator const end)
+        -> std::size_t
+    {
+        std::size_t column = 1;
+        for (auto it = begin; it != end; ++it) {
+            column += (*it == nullptr ? 0 : 1 + std::string_view(*it).size());
+        }
+        return column;
+    }
+
+    // The message, followed by the erroneous part of the command line unless it is empty
+    [[nodiscard]] auto make_message(
+        cppargs::Parse_error_info::Kind const kind, std::string_view const view) -> std::string
+    {
+        auto const message = cppargs::Parse_error_info::kind_to_string(kind);
+        return view.empty() ? std::string(message) : std::format("{}: '{}'", message, view);
+    }
+
+    // "; did you mean 'x'?" for the closest suggestion, or else the choices, with long lists cut
+    // short
+    [[nodiscard]] auto make_hint(
+        std::span<std::string const> const suggestions, std::span<std::string const> const choices)
+        -> std::string
+    {
+        constexpr std::size_t shown_choices = 10;
+
+        if (!suggestions.empty()) {
+            return std::format("; did you mean '{}'?", suggestions.front());
+        }
+        if (choices.empty()) {
+            return {};
+        }
+        std::string hint = "; expected one of: ";
+        for (std::size_t index = 0; index != std::min(choices.size(), shown_choices); ++index) {
+            hint.append(index == 0 ? "" : ", ").append(choices[index]);
+        }
+        if (choices.size() > shown_choices) {
+            std::format_to(
+                std::back_inserter(hint), ", and {} more", choices.size() - shown_choices);
+        }
+        return hint;
+    }
+
     [[nodiscard]] auto error_substring(cppargs::Parse_error_info const& info) -> std::string_view
     {
         return std::string_view(info.command_line).substr(info.error_column - 1, info.error_width);
@@ -18,7 +101,21 @@ auto cppargs::Parse_error_info::kind_to_string(Kind const kind) -> std::string_v
     case Parse_error_info::Kind::unrecognized_option:
         return "Unrecognized option";
     case Parse_error_info::Kind::positional_argument:
-        return "Positional arguments are not supported yet";
+        return "Unexpected positional argument";
+    case Parse_error_info::Kind::unreadable_response_file:
+        return "Could not read response file";
+    case Parse_error_info::Kind::recursive_response_file:
+        return "Recursive response file";
+    case Parse_error_info::Kind::unterminated_quote:
+        return "Unterminated quote";
+    case Parse_error_info::Kind::malformed_line:
+        return "Malformed line";
+    case Parse_error_info::Kind::missing_positional_argument:
+        return "Missing positional argument";
+    case Parse_error_info::Kind::missing_subcommand:
+        return "Missing subcommand";
+    case Parse_error_info::Kind::unrecognized_subcommand:
+        return "Unrecognized subcommand";
     default:
         throw std::invalid_argument {
             "cppargs::Parse_error_info::kind_to_string: Invalid "
@@ -27,13 +124,105 @@ auto cppargs::Parse_error_info::kind_to_string(Kind const kind) -> std::string_v
     }
 }
 
+cppargs::Parse_error::Parse_error(
+    Command_line const                      command_line,
+    std::size_t const                       argument,
+    Parse_error_info::Kind const            kind,
+    std::string_view const                  view,
+    Source_file const* const                file,
+    std::span<std::string_view const> const choices) noexcept
+    : m_command_line(command_line)
+    , m_argument(argument)
+    , m_offset(error_offset(command_line, argument, view, file))
+    , m_view(view)
+    , m_kind(kind)
+    , m_file(file)
+    , m_choices(choices)
+{}
+
+auto cppargs::Parse_error::kind() const noexcept -> Parse_error_info::Kind
+{
+    return m_kind;
+}
+
+auto cppargs::Parse_error::view() const noexcept -> std::string_view
+{
+    return m_view;
+}
+
+auto cppargs::Parse_error::argument_index() const noexcept -> std::size_t
+{
+    return m_argument;
+}
+
+auto cppargs::Parse_error::file() const noexcept -> Source_file const*
+{
+    return m_file;
+}
+
+auto cppargs::Parse_error::choices() const noexcept -> std::span<std::string_view const>
+{
+    return m_choices;
+}
+
+auto cppargs::Parse_error::line() const noexcept -> std::size_t
+{
+    if (m_file == nullptr) {
+        return 1;
+    }
+    return 1 + static_cast<std::size_t>(std::ranges::count(m_file->text.substr(0, m_offset), '\n'));
+}
+
+auto cppargs::Parse_error::column() const noexcept -> std::size_t
+{
+    if (m_file != nullptr) {
+        return 1 + m_offset - line_offset(m_file->text, m_offset);
+    }
+    auto const argument = m_command_line.begin() + static_cast<std::ptrdiff_t>(m_argument);
+    return command_line_column(m_command_line.begin(), argument) + m_offset;
+}
+
+auto cppargs::Parse_error::command_line_string() const -> std::string
+{
+    if (m_file != nullptr) {
+        auto const text  = m_file->text;
+        auto const begin = line_offset(text, m_offset);
+        auto const end   = std::min(text.find('\n', begin), text.size());
+        return std::string(text.substr(begin, end - begin));
+    }
+    return make_command_line_string(m_command_line);
+}
+
+auto cppargs::Parse_error::message() const -> std::string
+{
+    return make_message(m_kind, m_view);
+}
+
+auto cppargs::Parse_error::info() const -> Parse_error_info
+{
+    Parse_error_info info {
+        .command_line = command_line_string(),
+        .kind         = m_kind,
+        .error_column = column(),
+        .error_width  = m_view.size(),
+        .source       = m_file == nullptr ? std::string() : m_file->path,
+        .error_line   = line(),
+        .suggestions  = {},
+        .choices      = {},
+    };
+    dtl::add_choices(info, m_view, m_choices);
+    return info;
+}
+
 cppargs::Exception::Exception(Parse_error_info&& parse_error_info)
-    : m_exception_string(std::format(
-        "{}: '{}'",
-        Parse_error_info::kind_to_string(parse_error_info.kind),
-        error_substring(parse_error_info)))
+    : m_exception_string(make_message(parse_error_info.kind, error_substring(parse_error_info)))
     , m_parse_error_info(std::move(parse_error_info))
-{}
+{
+    m_exception_string.append(
+        make_hint(m_parse_error_info.suggestions, m_parse_error_info.choices));
+}
+
+cppargs::Exception::Exception(Parse_error const& parse_error) : Exception(parse_error.info()) {}
 
 auto cppargs::Exception::info() const noexcept -> Parse_error_info const&
 {
@@ -44,3 +233,88 @@ auto cppargs::Exception::what() const noexcept -> char const*
 {
     return m_exception_string.data();
 }
+
+auto cppargs::Diagnostics::add(
+    Parse_error const& error, std::span<std::string_view const> const suggestions) -> void
+{
+    m_suggestions.emplace_back(suggestions.begin(), suggestions.end());
+    m_errors.push_back(error);
+}
+
+auto cppargs::Diagnostics::clear() noexcept -> void
+{
+    m_errors.clear();
+    m_suggestions.clear();
+}
+
+auto cppargs::Diagnostics::errors() const noexcept -> std::span<Parse_error const>
+{
+    return m_errors;
+}
+
+auto cppargs::Diagnostics::empty() const noexcept -> bool
+{
+    return m_errors.empty();
+}
+
+auto cppargs::Diagnostics::suggestions(std::size_t const index) const
+    -> std::span<std::string const>
+{
+    return m_suggestions.at(index);
+}
+
+auto cppargs::Diagnostics::render() const -> std::string
+{
+    std::string string;
+    auto        output = std::back_inserter(string);
+
+    Source_file const* file = nullptr;
+    std::size_t        line = 0; // No line has been shown yet
+
+    for (std::size_t index = 0; index != m_errors.size(); ++index) {
+        auto const& error = m_errors[index];
+
+        // Consecutive errors on the same line share one copy of it.
+        if (line == 0 || error.file() != file || error.line() != line) {
+            file = error.file();
+            line = error.line();
+            if (file != nullptr && !file->path.empty()) {
+                std::format_to(output, "{}:{}:\n", file->path, line);
+            }
+            std::format_to(output, "{}\n", error.command_line_string());
+        }
+        Parse_error_info hint;
+        hint.suggestions = m_suggestions[index];
+        dtl::add_choices(hint, error.view(), error.choices());
+
+        auto const width = std::max<std::size_t>(1, error.view().size());
+        std::format_to(
+            output,
+            "{:{}}^{:~<{}} {}{}\n",
+            "",
+            error.column() - 1,
+            "",
+            width - 1,
+            make_message(error.kind(), error.view()),
+            make_hint(hint.suggestions, hint.choices));
+    }
+    return string;
+}
+
+auto cppargs::dtl::add_choices(
+    Parse_error_info&                       info,
+    std::string_view const                  view,
+    std::span<std::string_view const> const choices) -> void
+{
+    if (choices.empty()) {
+        return;
+    }
+    Name_ranking ranking(view, 1);
+    for (auto const choice : choices) {
+        info.choices.emplace_back(choice);
+        (void)ranking.add(choice);
+    }
+    for (auto const name : ranking.names()) {
+        info.suggestions.emplace_back(name);
+    }
+}
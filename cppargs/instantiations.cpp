@@ -0,0 +1,26 @@
+#include <cppargs.hpp>
+#include <cache.hpp>
+#include <schema.hpp>
+
+#define CPPARGS_DTL_DEFINE_INTEGER(T) template struct cppargs::Argument<T>;
+#define CPPARGS_DTL_DEFINE_ARGUMENT(T)                                           \
+    CPPARGS_DTL_INSTANTIATE(, T) CPPARGS_DTL_INSTANTIATE(, cppargs::Incremental<T>) \
+    CPPARGS_DTL_INSTANTIATE_SCHEMA(, T)                                          \
+    CPPARGS_DTL_INSTANTIATE_SCHEMA(, cppargs::Incremental<T>)
+
+CPPARGS_DTL_FOR_EACH_INTEGER(CPPARGS_DTL_DEFINE_INTEGER)
+CPPARGS_DTL_FOR_EACH_ARGUMENT(CPPARGS_DTL_DEFINE_ARGUMENT)
+CPPARGS_DTL_INSTANTIATE(, bool)
+CPPARGS_DTL_INSTANTIATE_SCHEMA(, bool)
+
+// Translation units that add parameters of the built-in types only see the declarations of these,
+// whether or not the parameters are added through the functions above.
+#define CPPARGS_DTL_DEFINE_SAVED(T)                                                \
+    template auto cppargs::dtl::save_values<T>(void const*, std::string&) -> void; \
+    template auto cppargs::dtl::load_values<T>(void*, std::string_view&) -> bool;
+#define CPPARGS_DTL_DEFINE_CACHED(T) \
+    CPPARGS_DTL_DEFINE_SAVED(T) CPPARGS_DTL_DEFINE_SAVED(cppargs::Incremental<T>)
+
+CPPARGS_DTL_FOR_EACH_ARGUMENT(CPPARGS_DTL_DEFINE_CACHED)
+CPPARGS_DTL_DEFINE_CACHED(bool)
+CPPARGS_DTL_DEFINE_CACHED(std::pmr::string)
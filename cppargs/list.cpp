@@ -0,0 +1,87 @@
+#include <cppargs.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CPPARGS_SSE2
+#endif
+
+namespace {
+    constexpr std::size_t max_digits = 19;
+
+    constexpr std::uint64_t powers_of_ten[] {
+        1, 10, 100, 1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000,
+    };
+
+    [[nodiscard]] constexpr auto is_digit(char const character) noexcept -> bool
+    {
+        return static_cast<unsigned char>(character - '0') < 10;
+    }
+
+    // Length of the run of digits at `begin`, or more than `max_digits` if it is too long
+    [[nodiscard]] auto digit_run(char const* const begin, char const* const end) noexcept
+        -> std::size_t
+    {
+        char const* it = begin;
+#if defined(CPPARGS_SSE2)
+        for (; end - it >= 16 && static_cast<std::size_t>(it - begin) <= max_digits; it += 16) {
+            auto const chunk  = _mm_loadu_si128(reinterpret_cast<__m128i const*>(it));
+            auto const values = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+            auto const digits = _mm_cmpeq_epi8(_mm_min_epu8(values, _mm_set1_epi8(9)), values);
+            auto const others = ~static_cast<std::uint32_t>(_mm_movemask_epi8(digits)) & 0xFFFF;
+            if (others != 0) {
+                return static_cast<std::size_t>(it - begin) + std::countr_zero(others);
+            }
+        }
+#endif
+        while (it != end && is_digit(*it) && static_cast<std::size_t>(it - begin) <= max_digits) {
+            ++it;
+        }
+        return static_cast<std::size_t>(it - begin);
+    }
+
+    // Converts the `count` digits at `it`, where `count` is between 1 and 8, with a handful of
+    // multiplications instead of one per digit.
+    [[nodiscard]] auto convert_digits(
+        char const* const it, char const* const end, std::size_t const count) noexcept
+        -> std::uint64_t
+    {
+        if constexpr (std::endian::native != std::endian::little) {
+            std::uint64_t value {};
+            for (std::size_t index = 0; index != count; ++index) {
+                value = value * 10 + static_cast<std::uint64_t>(it[index] - '0');
+            }
+            return value;
+        }
+        else {
+            std::uint64_t word {};
+            std::memcpy(&word, it, std::min<std::size_t>(8, static_cast<std::size_t>(end - it)));
+            // Bytes past the digits only borrow upward, and are shifted out. The bytes shifted
+            // in act as leading zeros.
+            word = (word - 0x3030303030303030) << (8 * (8 - count));
+            word = (word * 10) + (word >> 8);
+            return (((word & 0x000000FF000000FF) * (100 + (1000000ULL << 32)))
+                    + (((word >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32))))
+                >> 32;
+        }
+    }
+} // namespace
+
+auto cppargs::dtl::scan_digits(
+    char const* const begin, char const* const end, std::uint64_t& value) noexcept -> char const*
+{
+    auto const length = digit_run(begin, end);
+    if (length > max_digits) {
+        return nullptr;
+    }
+    value = 0;
+    for (std::size_t position = 0; position != length;) {
+        // The first chunk takes the remainder, so the rest are exactly 8 digits
+        auto const count = (length - position - 1) % 8 + 1;
+        value = value * powers_of_ten[count] + convert_digits(begin + position, end, count);
+        position += count;
+    }
+    return begin + length;
+}
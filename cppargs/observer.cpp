@@ -0,0 +1,31 @@
+#include <cppargs.hpp>
+#include <observer.hpp>
+
+cppargs::Counting_resource::Counting_resource(std::pmr::memory_resource* const upstream) noexcept
+    : m_upstream(upstream)
+{}
+
+auto cppargs::Counting_resource::bytes_allocated() const noexcept -> std::size_t
+{
+    return m_bytes_allocated;
+}
+
+auto cppargs::Counting_resource::do_allocate(std::size_t const size, std::size_t const alignment)
+    -> void*
+{
+    void* const pointer = m_upstream->allocate(size, alignment);
+    m_bytes_allocated += size;
+    return pointer;
+}
+
+auto cppargs::Counting_resource::do_deallocate(
+    void* const pointer, std::size_t const size, std::size_t const alignment) -> void
+{
+    m_upstream->deallocate(pointer, size, alignment);
+}
+
+auto cppargs::Counting_resource::do_is_equal(std::pmr::memory_resource const& other) const noexcept
+    -> bool
+{
+    return this == &other;
+}
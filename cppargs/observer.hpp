@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cppargs.hpp>
+#include <chrono>
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+
+namespace cppargs {
+
+    // Memory resource that counts the bytes allocated through it. Observed parses of parameters
+    // that allocate from it report the bytes allocated for each token. Not thread safe.
+    class Counting_resource : public std::pmr::memory_resource {
+        std::pmr::memory_resource* m_upstream;
+        std::size_t                m_bytes_allocated {};
+
+        auto do_allocate(std::size_t size, std::size_t alignment) -> void* override;
+        auto do_deallocate(void* pointer, std::size_t size, std::size_t alignment)
+            -> void override;
+        auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override;
+    public:
+        explicit Counting_resource(
+            std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept;
+
+        // Total bytes allocated so far, regardless of deallocations
+        [[nodiscard]] auto bytes_allocated() const noexcept -> std::size_t;
+    };
+
+    // What happened while parsing one token of an observed parse
+    struct Token_event {
+        std::string_view                      token;
+        std::size_t                           argument {};  // Index of the command line argument
+        Source_file const*                    file {};      // The containing response file, or null
+        dtl::Parameter_info const*            parameter {}; // The matched parameter, or null
+        std::size_t                           lookups {};
+        std::chrono::nanoseconds              lookup_time {};
+        std::chrono::nanoseconds              conversion_time {};
+        std::size_t                           bytes_allocated {};
+        std::optional<Parse_error_info::Kind> error;
+    };
+
+    // Totals of an observed parse
+    struct Parse_stats {
+        std::size_t              tokens {};
+        std::size_t              lookups {};
+        std::size_t              conversions {};
+        std::size_t              errors {};
+        std::size_t              bytes_allocated {};
+        std::chrono::nanoseconds lookup_time {};
+        std::chrono::nanoseconds conversion_time {};
+        std::chrono::nanoseconds exception_time {}; // Spent building the thrown `Exception`
+        std::chrono::nanoseconds total_time {};
+    };
+
+    // Receives the events of an observed parse. Parses without an observer are compiled
+    // without any instrumentation, so they cost nothing extra.
+    class Parse_observer {
+    public:
+        Parse_observer()                                         = default;
+        Parse_observer(Parse_observer const&)                    = default;
+        auto operator=(Parse_observer const&) -> Parse_observer& = default;
+        virtual ~Parse_observer()                                = default;
+
+        // Called after each token. Errors are reported for the token where they were found.
+        virtual auto on_token(Token_event const&) -> void {}
+
+        // Called once at the end of the parse, before any exception is thrown
+        virtual auto on_finish(Parse_stats const&) -> void {}
+    };
+
+    auto parse(Command_line command_line, Parameters const& parameters, Parse_observer& observer)
+        -> void;
+
+    [[nodiscard]] auto try_parse(
+        Command_line command_line, Parameters const& parameters, Parse_observer& observer)
+        -> std::optional<Parse_error>;
+
+} // namespace cppargs
@@ -1,36 +1,435 @@
 #include <cppargs.hpp>
-#include <format>
+#include <suggestions.hpp>
+#include <algorithm>
 
-auto cppargs::Parameters::help_string() const -> std::string
+namespace {
+    // Width of "--long-name, -s [type]" in the help text
+    [[nodiscard]] auto help_names_width(
+        cppargs::dtl::Parameter_info const& info, cppargs::dtl::Parameter_help const& help) noexcept
+        -> std::size_t
+    {
+        return 2 + info.long_name.size() + (info.short_name.has_value() ? 4 : 0)
+             + (info.is_flag ? 0 : help.type_name.size() + 3);
+    }
+
+    // Width of "<name>", "[name]", or "<name>..." in the help text
+    [[nodiscard]] auto help_positional_width(
+        cppargs::dtl::Parameter_info const& info, bool const variadic) noexcept -> std::size_t
+    {
+        return 2 + info.long_name.size() + (variadic ? 3 : 0);
+    }
+
+    // Width of "-- [name]..." in the help text
+    [[nodiscard]] auto help_trailing_width(cppargs::dtl::Trailing_info const& info) noexcept
+        -> std::size_t
+    {
+        return 8 + info.name.size();
+    }
+
+    // Label of the line listing the valid arguments of a parameter in the help text
+    constexpr std::string_view help_choices_label = "One of: ";
+
+    // Size of the lines listing `choices` in the help text, without wrapping
+    [[nodiscard]] auto help_choices_size(
+        std::span<std::string_view const> const choices, std::size_t const indent) noexcept
+        -> std::size_t
+    {
+        if (choices.empty()) {
+            return 0;
+        }
+        std::size_t size = 2 + indent + help_choices_label.size();
+        for (auto const choice : choices) {
+            size += choice.size() + 2;
+        }
+        return size;
+    }
+
+    [[nodiscard]] auto help_description(std::string_view const description) noexcept
+        -> std::string_view
+    {
+        return description.empty() ? "..." : description;
+    }
+
+    [[nodiscard]] auto help_description(cppargs::dtl::Parameter_help const& help) noexcept
+        -> std::string_view
+    {
+        return help_description(help.description);
+    }
+} // namespace
+
+cppargs::Parameters::Parameters(std::pmr::memory_resource* const resource)
+    : m_resource(resource)
+    , m_vector(resource)
+    , m_help(resource)
+    , m_long_index(resource)
+    , m_sorted_names(resource)
+    , m_environment_index(resource)
+    , m_positionals(resource)
+    , m_positional_help(resource)
+{}
+
+auto cppargs::Parameters::resource() const noexcept -> std::pmr::memory_resource*
 {
-    std::vector<std::pair<std::string, std::string_view>> lines;
-    std::size_t                                           max_length {};
+    return m_resource;
+}
 
+auto cppargs::Parameters::help_string() const -> std::string
+{
+    // Each line is a tab, the padded names, " : ", the description, and a newline.
+    std::size_t size = 0;
+    for (auto const& help : m_help) {
+        size += m_help_names_width + 5 + help_description(help).size();
+    }
+    for (auto const& help : m_positional_help) {
+        size += m_help_names_width + 5 + help_description(help).size();
+    }
     for (auto const& parameter : m_vector) {
-        std::string line = std::format("--{}", parameter.long_name);
+        size += help_choices_size(parameter.value_type->choices, m_help_names_width + 3);
+    }
+    for (auto const& parameter : m_positionals) {
+        size += help_choices_size(parameter.value_type->choices, m_help_names_width + 3);
+    }
+    if (m_trailing.value != nullptr) {
+        size += m_help_names_width + 5 + help_description(m_trailing.description).size();
+    }
+    std::string string;
+    string.reserve(size);
+    help_to(std::back_inserter(string));
+    return string;
+}
+
+auto cppargs::Parameters::help_to(std::FILE* const file, std::size_t const width) const -> void
+{
+    auto const write = [](void* const context, std::string_view const text) {
+        (void)std::fwrite(text.data(), 1, text.size(), static_cast<std::FILE*>(context));
+    };
+    write_help({ .write = write, .context = file }, width);
+}
+
+auto cppargs::Parameters::write_help(dtl::Help_writer const writer, std::size_t const width) const
+    -> void
+{
+    constexpr std::size_t tab_width = 8;
+
+    auto const write = [&](std::string_view const text) { writer.write(writer.context, text); };
+    auto const pad   = [&](std::size_t count) {
+        constexpr std::string_view spaces = "                                ";
+        for (; count > spaces.size(); count -= spaces.size()) {
+            write(spaces);
+        }
+        write(spaces.substr(0, count));
+    };
+
+    // Descriptions start at `indent`, and are only wrapped if some space is left for them.
+    auto const indent    = tab_width + m_help_names_width + 3;
+    auto const available = width > indent ? width - indent : 0;
+
+    // Writes the rest of a line, after names of the given width
+    auto const describe = [&](std::size_t const names_width, std::string_view description) {
+        pad(m_help_names_width - names_width);
+        write(" : ");
+        while (available != 0 && description.size() > available) {
+            // Words longer than the available space are not broken.
+            auto split = description.rfind(' ', available);
+            if (split == std::string_view::npos || split == 0) {
+                split = description.find(' ', available);
+                if (split == std::string_view::npos) {
+                    break;
+                }
+            }
+            auto const last = description.find_last_not_of(' ', split);
+            write(description.substr(0, last == std::string_view::npos ? 0 : last + 1));
+            write("\n\t");
+            pad(indent - tab_width);
+            description.remove_prefix(
+                std::min(description.find_first_not_of(' ', split), description.size()));
+        }
+        write(description);
+        write("\n");
+    };
+
+    // Lists the valid arguments on lines of their own, below the description
+    auto const list = [&](std::span<std::string_view const> const choices) {
+        if (choices.empty()) {
+            return;
+        }
+        write("\t");
+        pad(indent - tab_width);
+        write(help_choices_label);
+        auto column = help_choices_label.size();
+        for (std::size_t index = 0; index != choices.size(); ++index) {
+            auto const choice = choices[index];
+            auto const comma  = index + 1 == choices.size() ? 0 : 1;
+            if (index != 0) {
+                if (available != 0 && column + 1 + choice.size() + comma > available) {
+                    write("\n\t");
+                    pad(indent - tab_width);
+                    column = 0;
+                }
+                else {
+                    write(" ");
+                    ++column;
+                }
+            }
+            write(choice);
+            write(comma == 0 ? "" : ",");
+            column += choice.size() + comma;
+        }
+        write("\n");
+    };
+
+    for (std::size_t index = 0; index != m_vector.size(); ++index) {
+        auto const& parameter = m_vector[index];
+        auto const& help      = m_help[index];
+        write("\t--");
+        write(parameter.long_name);
         if (parameter.short_name.has_value()) {
-            std::format_to(std::back_inserter(line), ", -{}", parameter.short_name.value());
+            char const short_name[] { ',', ' ', '-', parameter.short_name.value() };
+            write({ short_name, sizeof short_name });
         }
         if (!parameter.is_flag) {
-            std::format_to(std::back_inserter(line), " [{}]", parameter.type_name);
+            write(" [");
+            write(help.type_name);
+            write("]");
         }
-        max_length = std::max(max_length, line.size());
-        lines.emplace_back(std::move(line), parameter.description);
+        describe(help_names_width(parameter, help), help_description(help));
+        list(parameter.value_type->choices);
     }
-
-    std::string string;
-    for (auto const& [names, description] : lines) {
-        std::format_to(
-            std::back_inserter(string),
-            "\t{:{}} : {}\n",
-            names,
-            max_length,
-            description.empty() ? "..." : description);
+    for (std::size_t index = 0; index != m_positionals.size(); ++index) {
+        auto const& parameter = m_positionals[index];
+        auto const  required  = index < m_required_positionals;
+        auto const  variadic  = m_variadic_positional && index + 1 == m_positionals.size();
+        write(required ? "\t<" : "\t[");
+        write(parameter.long_name);
+        write(required ? ">" : "]");
+        if (variadic) {
+            write("...");
+        }
+        describe(
+            help_positional_width(parameter, variadic),
+            help_description(m_positional_help[index]));
+        list(parameter.value_type->choices);
+    }
+    if (m_trailing.value != nullptr) {
+        write("\t-- [");
+        write(m_trailing.name);
+        write("]...");
+        describe(help_trailing_width(m_trailing), help_description(m_trailing.description));
     }
-    return string;
 }
 
 auto cppargs::Parameters::info_span() const noexcept -> std::span<dtl::Parameter_info const>
 {
     return m_vector;
 }
+
+auto cppargs::Parameters::help_span() const noexcept -> std::span<dtl::Parameter_help const>
+{
+    return m_help;
+}
+
+auto cppargs::Parameters::help_of(dtl::Parameter_info const& info) const noexcept
+    -> dtl::Parameter_help const&
+{
+    return m_help[static_cast<std::size_t>(&info - m_vector.data())];
+}
+
+auto cppargs::Parameters::push(dtl::Parameter_info const& info, dtl::Parameter_help const& help)
+    -> void
+{
+    // If a name is registered more than once, the first registration wins.
+    m_long_index.try_emplace(info.long_name, m_vector.size());
+    m_sorted_names->reset();
+    if (info.short_name.has_value()) {
+        auto& slot = m_short_index[static_cast<unsigned char>(info.short_name.value())];
+        if (slot == 0) {
+            slot = static_cast<std::uint32_t>(m_vector.size() + 1);
+        }
+    }
+    m_help_names_width = std::max(m_help_names_width, help_names_width(info, help));
+    m_vector.push_back(info);
+    m_help.push_back(help);
+}
+
+auto cppargs::Parameters::push_positional(
+    dtl::Parameter_info const& info,
+    dtl::Parameter_help const& help,
+    Presence const             presence,
+    bool const                 variadic) -> void
+{
+    if (m_variadic_positional) {
+        throw std::invalid_argument {
+            "cppargs::Parameters::add_positional: Parameter added after an incremental one",
+        };
+    }
+    if (presence == Presence::required) {
+        if (m_required_positionals != m_positionals.size()) {
+            throw std::invalid_argument {
+                "cppargs::Parameters::add_positional: Required parameter added after an "
+                "optional one",
+            };
+        }
+        ++m_required_positionals;
+    }
+    m_variadic_positional = variadic;
+    m_help_names_width = std::max(m_help_names_width, help_positional_width(info, variadic));
+    m_positionals.push_back(info);
+    m_positional_help.push_back(help);
+}
+
+auto cppargs::Parameters::add_trailing(
+    std::string_view const name, std::string_view const description) -> Trailing_arguments
+{
+    if (m_trailing.value != nullptr) {
+        throw std::invalid_argument {
+            "cppargs::Parameters::add_trailing: Trailing arguments already added",
+        };
+    }
+    Trailing_arguments trailing(m_resource);
+    m_trailing = { .value = trailing.m_value.get(), .name = name, .description = description };
+    m_help_names_width = std::max(m_help_names_width, help_trailing_width(m_trailing));
+    return trailing;
+}
+
+auto cppargs::Parameters::positional_parameters() const noexcept -> dtl::Positional_parameters
+{
+    return {
+        .infos    = m_positionals,
+        .helps    = m_positional_help,
+        .required = m_required_positionals,
+        .variadic = m_variadic_positional,
+        .trailing = m_trailing.value,
+    };
+}
+
+auto cppargs::Parameters::find(std::string_view const long_name) const
+    -> dtl::Parameter_info const*
+{
+    auto const it = m_long_index.find(long_name);
+    return it == m_long_index.end() ? nullptr : &m_vector[it->second];
+}
+
+auto cppargs::Parameters::find(char const short_name) const noexcept -> dtl::Parameter_info const*
+{
+    auto const slot = m_short_index[static_cast<unsigned char>(short_name)];
+    return slot == 0 ? nullptr : &m_vector[slot - 1];
+}
+
+auto cppargs::Parameters::long_names() const -> std::span<std::string_view const>
+{
+    return m_sorted_names->get(m_vector);
+}
+
+auto cppargs::Parameters::allow_abbreviations(bool const allow) -> void
+{
+    m_abbreviations = allow;
+}
+
+auto cppargs::Parameters::match(std::string_view const long_name) const
+    -> dtl::Parameter_info const*
+{
+    if (auto const info = find(long_name); info != nullptr || !m_abbreviations) {
+        return info;
+    }
+    // The names starting with `long_name` are adjacent in sorted order.
+    auto const names = long_names();
+    auto const it    = std::ranges::lower_bound(names, long_name);
+    if (it == names.end() || !it->starts_with(long_name)) {
+        return nullptr;
+    }
+    auto const next = it + 1;
+    return next != names.end() && next->starts_with(long_name) ? nullptr : find(*it);
+}
+
+auto cppargs::Parameters::suggest(std::string_view const name, std::size_t const count) const
+    -> std::vector<std::string_view>
+{
+    auto const names    = long_names();
+    auto const starting = [](std::string_view const prefix) {
+        return [prefix](std::string_view const name) { return name.starts_with(prefix); };
+    };
+
+    if (m_abbreviations) {
+        auto const first = std::ranges::lower_bound(names, name);
+        auto const last  = std::partition_point(first, names.end(), starting(name));
+        if (first != last) {
+            return { first, first + std::min<std::ptrdiff_t>(last - first, count) };
+        }
+    }
+    dtl::Name_ranking ranking(name, count);
+    for (auto it = names.begin(); it != names.end();) {
+        if (auto const hopeless = ranking.add(*it)) {
+            it = std::partition_point(it, names.end(), starting(it->substr(0, hopeless.value())));
+        }
+        else {
+            ++it;
+        }
+    }
+    return ranking.names();
+}
+
+auto cppargs::Parameters::set_environment_prefix(std::string_view const prefix) -> void
+{
+    m_environment_prefix.emplace(prefix, m_resource);
+}
+
+auto cppargs::Parameters::set_environment_variable(
+    std::string_view const long_name, std::string_view const variable) -> void
+{
+    auto const it = m_long_index.find(long_name);
+    if (it == m_long_index.end()) {
+        throw std::invalid_argument {
+            "cppargs::Parameters::set_environment_variable: Unknown long name",
+        };
+    }
+    m_environment_index.insert_or_assign(std::pmr::string(variable, m_resource), it->second);
+}
+
+auto cppargs::Parameters::find_environment(std::string_view const name) const
+    -> dtl::Parameter_info const*
+{
+    if (!m_environment_index.empty()) {
+        if (auto const it = m_environment_index.find(name); it != m_environment_index.end()) {
+            return &m_vector[it->second];
+        }
+    }
+    if (!m_environment_prefix.has_value() || !name.starts_with(m_environment_prefix.value())) {
+        return nullptr;
+    }
+
+    auto const rest = name.substr(m_environment_prefix->size());
+    if (rest.empty()) {
+        return nullptr;
+    }
+    auto const to_long_name = [](char const character) {
+        return character == '_' ? '-'
+             : character >= 'A' && character <= 'Z' ? static_cast<char>(character - 'A' + 'a')
+                                                    : character;
+    };
+    // Only unusually long names are converted on the heap.
+    std::array<char, 128> buffer {};
+    if (rest.size() > buffer.size()) {
+        std::string long_name(rest.size(), '\0');
+        std::ranges::transform(rest, long_name.begin(), to_long_name);
+        return find(long_name);
+    }
+    std::ranges::transform(rest, buffer.begin(), to_long_name);
+    return find(std::string_view(buffer.data(), rest.size()));
+}
+
+auto cppargs::Parameters::uses_environment() const noexcept -> bool
+{
+    return m_environment_prefix.has_value() || !m_environment_index.empty();
+}
+
+auto cppargs::dtl::parse_setting(Parameter_info const& info, std::string_view const value) -> bool
+{
+    if (!info.is_flag) {
+        return info.parse(value, info.value);
+    }
+    auto const enabled = Argument<bool>::parse(value);
+    if (enabled.has_value() && enabled.value()) {
+        (void)info.parse({}, info.value);
+    }
+    return enabled.has_value();
+}
@@ -1,8 +1,15 @@
 #include <cppargs.hpp>
+#include <cache.hpp>
+#include <diagnostics.hpp>
+#include <observer.hpp>
+#include <parser.hpp>
+#include <schema.hpp>
+#include <subcommands.hpp>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cassert>
-#include <ranges>
-#include <format>
+#include <thread>
 
 namespace {
     [[nodiscard]] auto is_valid_command_line(cppargs::Command_line const command_line) noexcept
@@ -15,100 +22,1105 @@ namespace {
                });
     }
 
-    [[nodiscard]] auto make_command_line_string(cppargs::Command_line const command_line)
-        -> std::string
+    using Kind = cppargs::Parse_error_info::Kind;
+
+    struct Token {
+        std::string_view            string;
+        std::size_t                 argument {};
+        cppargs::Source_file const* file {};
+    };
+
+    // Yields the arguments of the command line or command string, expanding response files if
+    // enabled
+    class Token_stream {
+        struct Frame {
+            cppargs::Source_file const* file {};
+            std::size_t                 position {};
+        };
+
+        static constexpr std::string_view whitespace = " \t\n\r\v\f";
+
+        cppargs::Command_line               m_command_line;
+        cppargs::Command_string const*      m_command_string {};
+        cppargs::Response_files*            m_response_files {};
+        std::size_t                         m_argument {};
+        std::size_t                         m_next {};
+        std::vector<Frame>                  m_frames;
+        std::optional<cppargs::Parse_error> m_error;
+        Token                               m_current;
+
+        [[nodiscard]] auto next_unexpanded() -> std::optional<Token>
+        {
+            while (!m_frames.empty()) {
+                auto&      frame = m_frames.back();
+                auto const text  = frame.file->text;
+                auto const begin = text.find_first_not_of(whitespace, frame.position);
+                if (begin == std::string_view::npos) {
+                    m_frames.pop_back();
+                    continue;
+                }
+                auto const end = std::min(text.find_first_of(whitespace, begin), text.size());
+                frame.position = end;
+                return Token { text.substr(begin, end - begin), m_argument, frame.file };
+            }
+            if (m_command_string != nullptr) {
+                if (m_next < m_command_string->arguments().size()) {
+                    m_argument = m_next++;
+                    return Token { m_command_string->arguments()[m_argument], m_argument, nullptr };
+                }
+            }
+            else if (m_next < m_command_line.size()) {
+                m_argument = m_next++;
+                return Token { m_command_line[m_argument], m_argument, nullptr };
+            }
+            return std::nullopt;
+        }
+
+        [[nodiscard]] auto is_active(cppargs::Source_file const* const file) const noexcept -> bool
+        {
+            return std::ranges::find(m_frames, file, &Frame::file) != m_frames.end();
+        }
+    public:
+        // Starts at the argument at index `first`, which skips the program name by default
+        Token_stream(
+            cppargs::Command_line const    command_line,
+            cppargs::Response_files* const response_files,
+            std::size_t const              first = 1)
+            : m_command_line(command_line)
+            , m_response_files(response_files)
+            , m_next(first)
+        {}
+
+        Token_stream(
+            cppargs::Command_string const& command_string,
+            cppargs::Response_files* const response_files)
+            : m_command_string(&command_string)
+            , m_response_files(response_files)
+        {}
+
+        // Returns null at the end of the stream, or when a response file can not be expanded,
+        // in which case `error` holds the reason.
+        [[nodiscard]] auto next() -> std::optional<Token>
+        {
+            for (;;) {
+                auto token = next_unexpanded();
+                if (!token.has_value() || m_response_files == nullptr
+                    || token->string.size() < 2 || token->string.front() != '@')
+                {
+                    if (token.has_value()) {
+                        m_current = token.value();
+                    }
+                    return token;
+                }
+                auto const path = token->string.substr(1);
+                auto const file = m_response_files->open(path);
+                if (file == nullptr) {
+                    m_error = make_error(token.value(), Kind::unreadable_response_file, path);
+                    return std::nullopt;
+                }
+                if (is_active(file)) {
+                    m_error = make_error(token.value(), Kind::recursive_response_file, path);
+                    return std::nullopt;
+                }
+                m_frames.push_back({ .file = file, .position = 0 });
+            }
+        }
+
+        // The token most recently returned by `next`
+        [[nodiscard]] auto current() const noexcept -> Token const&
+        {
+            return m_current;
+        }
+
+        [[nodiscard]] auto error() const noexcept -> std::optional<cppargs::Parse_error> const&
+        {
+            return m_error;
+        }
+
+        // Whether `token` is an argument of the command line itself
+        [[nodiscard]] auto is_command_line_argument(Token const& token) const noexcept -> bool
+        {
+            return token.file == nullptr && m_command_string == nullptr;
+        }
+
+        // The command line arguments after the current one
+        [[nodiscard]] auto remaining_command_line() const noexcept -> cppargs::Command_line
+        {
+            return m_command_line.subspan(m_next);
+        }
+
+        // Error at the end of the input, after the last token
+        [[nodiscard]] auto make_end_error(Kind const kind) const noexcept -> cppargs::Parse_error
+        {
+            // Tokens always refer to some text, so a null token has not been set yet.
+            if (auto const string = m_current.string; string.data() != nullptr) {
+                return make_error(m_current, kind, string.substr(string.size()));
+            }
+            if (m_command_string != nullptr) {
+                auto const& source = m_command_string->source();
+                return cppargs::Parse_error(
+                    {}, 0, kind, source.text.substr(source.text.size()), &source);
+            }
+            std::string_view const program
+                = m_command_line.front() == nullptr ? "" : m_command_line.front();
+            return cppargs::Parse_error(m_command_line, 0, kind, program.substr(program.size()));
+        }
+
+        [[nodiscard]] auto make_error(
+            Token const&                            token,
+            Kind const                              kind,
+            std::string_view const                  view,
+            std::span<std::string_view const> const choices = {}) const noexcept
+            -> cppargs::Parse_error
+        {
+            if (token.file == nullptr && m_command_string != nullptr) {
+                return cppargs::Parse_error(
+                    {},
+                    token.argument,
+                    kind,
+                    m_command_string->locate(token.argument, view),
+                    &m_command_string->source(),
+                    choices);
+            }
+            return cppargs::Parse_error(
+                m_command_line, token.argument, kind, view, token.file, choices);
+        }
+    };
+
+    // Outcome of parsing a single argument
+    struct Step {
+        // Option at the end of the argument that takes the next argument as its value
+        cppargs::dtl::Parameter_info const* pending {};
+        std::string_view                    pending_name;
+
+        std::optional<Kind>               error;
+        std::string_view                  error_view;
+        std::span<std::string_view const> error_choices; // Of the parameter, if invalid
+    };
+
+    [[nodiscard]] auto failure(
+        Kind const                              kind,
+        std::string_view const                  view,
+        std::span<std::string_view const> const choices = {}) -> Step
     {
-        assert(is_valid_command_line(command_line));
-        std::string line = command_line.front();
-        std::for_each(
-            command_line.begin() + 1, command_line.end(), [&line](char const* const string) {
-                line.append(1, ' ').append(string);
-            });
-        return line;
-    }
-
-    [[nodiscard]] auto command_line_column(
-        cppargs::Command_line::iterator const begin, cppargs::Command_line::iterator const end)
-        -> std::size_t
+        Step step;
+        step.error         = kind;
+        step.error_view    = view;
+        step.error_choices = choices;
+        return step;
+    }
+
+    [[nodiscard]] auto awaiting_argument(
+        cppargs::dtl::Parameter_info const* const option, std::string_view const name) -> Step
     {
-        std::size_t column = 1;
-        for (auto it = begin; it != end; ++it) {
-            column += (*it == nullptr ? 0 : 1 + std::string_view(*it).size());
+        Step step;
+        step.pending      = option;
+        step.pending_name = name;
+        return step;
+    }
+
+    // Storage of a parameter added to `cppargs::Parameters`
+    struct Parameter_storage {
+        auto operator()(cppargs::dtl::Parameter_info const& info) const noexcept -> void*
+        {
+            return info.value;
+        }
+    };
+
+    // Storage of a parameter added to `cppargs::Schema`
+    struct Values_storage {
+        cppargs::Schema const* schema {};
+        cppargs::Values*       values {};
+
+        auto operator()(cppargs::dtl::Parameter_info const& info) const noexcept -> void*
+        {
+            return values->slot(static_cast<std::size_t>(&info - schema->info_span().data()));
         }
-        return column;
+    };
+
+    // Converts values as soon as they are scanned
+    template <class Storage>
+    struct Immediate_conversion {
+        Storage storage;
+
+        auto operator()(
+            cppargs::dtl::Parameter_info const& info, std::string_view const value) const -> bool
+        {
+            return info.parse(value, storage(info));
+        }
+    };
+
+    [[nodiscard]] auto positional_parameters(cppargs::Parameters const& parameters) noexcept
+        -> cppargs::dtl::Positional_parameters
+    {
+        return parameters.positional_parameters();
     }
-} // namespace
 
-auto cppargs::parse(Command_line const command_line, Parameters const& parameters) -> void
-{
-    if (!is_valid_command_line(command_line)) {
-        throw std::invalid_argument { "cppargs::parse: Invalid command line" };
+    [[nodiscard]] auto positional_parameters(cppargs::Schema const&) noexcept
+        -> cppargs::dtl::Positional_parameters
+    {
+        return {};
     }
 
-    for (auto arg_it = command_line.begin() + 1; arg_it != command_line.end(); ++arg_it) {
-        std::string_view const string = *arg_it;
+    // Whether `string`, which is not the value of an option, is a positional argument
+    [[nodiscard]] auto is_positional(std::string_view const string) noexcept -> bool
+    {
+        return string == "-" || !string.starts_with('-');
+    }
 
-        auto const exception = [&](Parse_error_info::Kind const kind,
-                                   std::string_view const       view,
-                                   std::size_t const            column_plus) {
-            return Exception { Parse_error_info {
-                .command_line = make_command_line_string(command_line),
-                .kind         = kind,
-                .error_column = command_line_column(command_line.begin(), arg_it) + column_plus,
-                .error_width  = view.size(),
-            } };
-        };
+    // The parameter that takes a positional argument after `count` others, or null
+    [[nodiscard]] auto positional_parameter(
+        cppargs::dtl::Positional_parameters const& positional, std::size_t const count) noexcept
+        -> cppargs::dtl::Parameter_info const*
+    {
+        if (count < positional.infos.size()) {
+            return &positional.infos[count];
+        }
+        return positional.variadic ? &positional.infos.back() : nullptr;
+    }
 
-        if (string != "--" && string.starts_with("--")) {
-            auto const name = string.substr(2);
-            auto const it
-                = std::ranges::find(parameters.info_span(), name, &dtl::Parameter_info::long_name);
+    using Clock = std::chrono::steady_clock;
 
-            if (it == parameters.info_span().end()) {
-                throw exception(Parse_error_info::Kind::unrecognized_option, name, 2);
+    // Stands in for `Observation` in parses without an observer
+    struct No_observation {
+        auto begin(Token const&) noexcept -> void {}
+    };
+
+    // Collects the events of an observed parse, and reports each token once the next one begins
+    class Observation {
+        cppargs::Parse_observer*          m_observer;
+        cppargs::Counting_resource const* m_counter;
+        cppargs::Parse_stats              m_stats;
+        cppargs::Token_event              m_event;
+        std::size_t                       m_bytes_before {};
+        bool                              m_active {};
+
+        [[nodiscard]] auto bytes_allocated() const noexcept -> std::size_t
+        {
+            return m_counter == nullptr ? 0 : m_counter->bytes_allocated();
+        }
+
+        auto flush() -> void
+        {
+            if (m_active) {
+                m_active                = false;
+                m_event.bytes_allocated = bytes_allocated() - m_bytes_before;
+                m_stats.bytes_allocated += m_event.bytes_allocated;
+                m_observer->on_token(m_event);
             }
-            else if (it->is_flag) {
-                (void)it->parse({}, it->value);
+        }
+    public:
+        Observation(
+            cppargs::Parse_observer& observer, std::pmr::memory_resource const* const resource)
+            : m_observer(&observer)
+            , m_counter(dynamic_cast<cppargs::Counting_resource const*>(resource))
+        {}
+
+        auto begin(Token const& token) -> void
+        {
+            flush();
+            m_event        = { .token           = token.string,
+                               .argument        = token.argument,
+                               .file            = token.file,
+                               .parameter       = nullptr,
+                               .lookups         = 0,
+                               .lookup_time     = {},
+                               .conversion_time = {},
+                               .bytes_allocated = 0,
+                               .error           = std::nullopt };
+            m_bytes_before = bytes_allocated();
+            m_active       = true;
+            ++m_stats.tokens;
+        }
+
+        template <class Find>
+        auto lookup(Find const& find) -> cppargs::dtl::Parameter_info const*
+        {
+            auto const start = Clock::now();
+            auto const info  = find();
+            auto const time  = Clock::now() - start;
+            ++m_event.lookups;
+            ++m_stats.lookups;
+            m_event.lookup_time += time;
+            m_stats.lookup_time += time;
+            if (info != nullptr) {
+                m_event.parameter = info;
             }
-            else if (arg_it + 1 == command_line.end()) {
-                throw exception(Parse_error_info::Kind::missing_argument, name, 2);
+            return info;
+        }
+
+        template <class Convert>
+        auto convert(cppargs::dtl::Parameter_info const& info, Convert const& convert) -> bool
+        {
+            auto const start  = Clock::now();
+            auto const result = convert();
+            auto const time   = Clock::now() - start;
+            ++m_stats.conversions;
+            m_event.conversion_time += time;
+            m_stats.conversion_time += time;
+            m_event.parameter = &info;
+            return result;
+        }
+
+        // Reports the last token, with the error if any, and the totals
+        auto finish(
+            std::optional<cppargs::Parse_error> const& error,
+            Clock::duration const                      total_time,
+            Clock::duration const                      exception_time) -> void
+        {
+            if (error.has_value()) {
+                m_event.error = error->kind();
+                ++m_stats.errors;
             }
-            else if (!it->parse(*++arg_it, it->value)) {
-                throw exception(Parse_error_info::Kind::invalid_argument, *arg_it, 0);
+            flush();
+            m_stats.total_time     = total_time;
+            m_stats.exception_time = exception_time;
+            m_observer->on_finish(m_stats);
+        }
+    };
+
+    // Times the lookups of `Parameters`
+    template <class Parameters>
+    struct Observed_parameters {
+        Parameters const* parameters {};
+        Observation*      observation {};
+
+        auto find(std::string_view const name) const -> cppargs::dtl::Parameter_info const*
+        {
+            return observation->lookup([&] { return parameters->find(name); });
+        }
+
+        auto find(char const name) const -> cppargs::dtl::Parameter_info const*
+        {
+            return observation->lookup([&] { return parameters->find(name); });
+        }
+
+        auto match(std::string_view const name) const -> cppargs::dtl::Parameter_info const*
+        {
+            return observation->lookup([&] { return parameters->match(name); });
+        }
+    };
+
+    template <class Parameters>
+    [[nodiscard]] auto positional_parameters(Observed_parameters<Parameters> const& parameters)
+        -> cppargs::dtl::Positional_parameters
+    {
+        return positional_parameters(*parameters.parameters);
+    }
+
+    // Times the conversions of `Conversion`
+    template <class Conversion>
+    struct Observed_conversion {
+        Conversion   conversion;
+        Observation* observation {};
+
+        auto operator()(
+            cppargs::dtl::Parameter_info const& info, std::string_view const value) const -> bool
+        {
+            return observation->convert(info, [&] { return conversion(info, value); });
+        }
+    };
+
+    // Parses `string`, which is the value of `pending` if it is not null
+    template <class Parameters, class Conversion>
+    [[nodiscard]] auto parse_argument(
+        Parameters const&                         parameters,
+        Conversion const&                         convert,
+        cppargs::dtl::Parameter_info const* const pending,
+        std::string_view const                    string) -> Step
+    {
+        if (pending != nullptr) {
+            if (convert(*pending, string)) {
+                return {};
             }
+            return failure(Kind::invalid_argument, string, pending->value_type->choices);
+        }
+        else if (string != "--" && string.starts_with("--")) {
+            auto const name = string.substr(2);
+            auto const it   = parameters.match(name);
+
+            if (it == nullptr) {
+                return failure(Kind::unrecognized_option, name);
+            }
+            else if (it->is_flag) {
+                (void)convert(*it, {});
+                return {};
+            }
+            return awaiting_argument(it, name);
         }
         else if (string != "--" && string != "-" && string.starts_with('-')) {
-            std::size_t offset = 1;
-            for (auto char_it = string.begin() + 1; char_it != string.end(); ++char_it, ++offset) {
+            for (auto char_it = string.begin() + 1; char_it != string.end(); ++char_it) {
                 auto const name = std::string_view(char_it, 1);
-                auto const it   = std::ranges::find(
-                    parameters.info_span(), *char_it, &dtl::Parameter_info::short_name);
+                auto const it   = parameters.find(*char_it);
 
-                if (it == parameters.info_span().end()) {
-                    throw exception(Parse_error_info::Kind::unrecognized_option, name, offset);
+                if (it == nullptr) {
+                    return failure(Kind::unrecognized_option, name);
                 }
                 else if (it->is_flag) {
-                    (void)it->parse({}, it->value);
+                    (void)convert(*it, {});
                 }
                 else if (char_it + 1 != string.end()) {
                     std::string_view const argument(char_it + 1, string.end());
-                    if (it->parse(argument, it->value)) {
+                    if (convert(*it, argument)) {
+                        return {};
+                    }
+                    return failure(Kind::invalid_argument, argument, it->value_type->choices);
+                }
+                else {
+                    return awaiting_argument(it, name);
+                }
+            }
+            return {};
+        }
+        return failure(Kind::positional_argument, string);
+    }
+
+    // Stops parsing at the first error
+    struct Stop_at_error {
+        auto operator()(cppargs::Parse_error const& error) const noexcept
+            -> std::optional<cppargs::Parse_error>
+        {
+            return error;
+        }
+    };
+
+    // Records errors, with suggestions from `parameters`, and continues parsing
+    struct Collect_errors {
+        cppargs::Diagnostics*      diagnostics {};
+        cppargs::Parameters const* parameters {};
+
+        auto operator()(cppargs::Parse_error const& error) const
+            -> std::optional<cppargs::Parse_error>
+        {
+            diagnostics->add(error, error.suggestions(*parameters));
+            return std::nullopt;
+        }
+    };
+
+    // If `first_positional` is not null, stops at the first positional argument and stores it
+    // there instead of parsing it. Errors are passed to `fail`, which returns the error to stop
+    // parsing with, or nothing to continue with the next argument.
+    template <
+        class Parameters,
+        class Conversion,
+        class Observer = No_observation,
+        class Fail     = Stop_at_error>
+    [[nodiscard]] auto parse_tokens(
+        Token_stream&         stream,
+        Parameters const&     parameters,
+        Conversion const&     convert,
+        std::optional<Token>* first_positional = nullptr,
+        Observer&&            observer         = {},
+        Fail const&           fail             = {}) -> std::optional<cppargs::Parse_error>
+    {
+        auto const  positional = positional_parameters(parameters);
+        std::size_t positional_count {};
+        bool        options = true; // Cleared by `--`
+        bool        unrecognized {}; // Whether the previous argument was an unrecognized option
+        Step        pending;
+        Token       pending_token;
+
+        while (auto const token = stream.next()) {
+            observer.begin(token.value());
+            auto const string             = token->string;
+            auto const after_unrecognized = std::exchange(unrecognized, false);
+            auto const ends_options = options && string == "--";
+            if (pending.pending == nullptr && (!options || ends_options || is_positional(string))) {
+                if (ends_options) {
+                    options = false;
+                    // Only the command line itself can be referred to without copying.
+                    if (positional.trailing != nullptr && stream.is_command_line_argument(*token)) {
+                        *positional.trailing = stream.remaining_command_line();
                         break;
                     }
-                    throw exception(Parse_error_info::Kind::invalid_argument, argument, offset + 1);
+                    continue;
+                }
+                if (first_positional != nullptr) {
+                    *first_positional = token;
+                    return std::nullopt;
+                }
+                auto const info = positional_parameter(positional, positional_count++);
+                // When errors are collected, an argument that fails after an unrecognized option
+                // is taken to be its value, which was already reported with it.
+                if ((info == nullptr || !convert(*info, string)) && !after_unrecognized) {
+                    auto const kind    = info == nullptr ? Kind::positional_argument
+                                                         : Kind::invalid_argument;
+                    auto const choices = info == nullptr ? std::span<std::string_view const> {}
+                                                         : info->value_type->choices;
+                    if (auto error = fail(stream.make_error(*token, kind, string, choices))) {
+                        return error;
+                    }
+                }
+                continue;
+            }
+            auto const step = parse_argument(parameters, convert, pending.pending, string);
+            if (step.error.has_value()) {
+                auto const error
+                    = stream.make_error(*token, *step.error, step.error_view, step.error_choices);
+                if (auto failure = fail(error)) {
+                    return failure;
+                }
+                pending      = {};
+                unrecognized = step.error == Kind::unrecognized_option;
+                continue;
+            }
+            pending       = step;
+            pending_token = token.value();
+        }
+        if (stream.error().has_value()) {
+            return fail(stream.error().value());
+        }
+        if (pending.pending != nullptr) {
+            if (auto error = fail(
+                    stream.make_error(pending_token, Kind::missing_argument, pending.pending_name)))
+            {
+                return error;
+            }
+        }
+        if (positional_count < positional.required) {
+            return fail(stream.make_end_error(Kind::missing_positional_argument));
+        }
+        return std::nullopt;
+    }
+
+    // Value scanned by the first pass of a parallel parse
+    struct Deferred {
+        cppargs::dtl::Parameter_info const* info {};
+        std::string_view                    value;
+        Token                               token;
+    };
+
+    // Records values instead of converting them
+    struct Deferred_conversion {
+        Token_stream const*    stream {};
+        std::vector<Deferred>* deferred {};
+
+        auto operator()(
+            cppargs::dtl::Parameter_info const& info, std::string_view const value) const -> bool
+        {
+            deferred->push_back({ .info = &info, .value = value, .token = stream->current() });
+            return true;
+        }
+    };
+
+    // Consecutive deferred values, converted by one thread into temporary storage
+    struct Chunk {
+        using Info = cppargs::dtl::Parameter_info;
+
+        std::pmr::monotonic_buffer_resource         resource;
+        std::pmr::unordered_map<Info const*, void*> temporaries { &resource };
+        std::optional<std::size_t>                  failure; // Index of the failed value
+        std::exception_ptr                          exception;
+
+        Chunk() = default;
+
+        Chunk(Chunk const&)                    = delete;
+        auto operator=(Chunk const&) -> Chunk& = delete;
+
+        ~Chunk()
+        {
+            for (auto const& [info, temporary] : temporaries) {
+                info->value_type->destroy(temporary);
+            }
+        }
+
+        auto convert(std::span<Deferred const> const deferred, std::size_t const offset) -> void
+        {
+            for (std::size_t index = 0; index != deferred.size(); ++index) {
+                auto const& [info, value, token] = deferred[index];
+
+                auto it = temporaries.find(info);
+                if (it == temporaries.end()) {
+                    auto const& type      = *info->value_type;
+                    void* const temporary = resource.allocate(type.size, type.alignment);
+                    type.construct(temporary, &resource);
+                    it = temporaries.emplace(info, temporary).first;
+                }
+                if (!info->parse(value, it->second)) {
+                    failure = offset + index;
+                    return;
+                }
+            }
+        }
+    };
+
+    // Second pass of a parallel parse. Values are split into chunks converted on separate
+    // threads, which are then merged in order. Returns the index of the first value that could
+    // not be converted, if any, in which case only the values before it are stored.
+    template <class Storage>
+    [[nodiscard]] auto convert_parallel(
+        std::span<Deferred const> const deferred,
+        Storage const&                  storage,
+        std::size_t const               thread_count) -> std::optional<std::size_t>
+    {
+        // More chunks than threads, so that threads finishing early can take over remaining work
+        auto const chunk_count = std::min(deferred.size(), thread_count * 4);
+        if (chunk_count == 0) {
+            return std::nullopt;
+        }
+        auto const chunk_size = (deferred.size() + chunk_count - 1) / chunk_count;
+        auto const chunks     = std::make_unique<Chunk[]>(chunk_count);
+
+        std::atomic<std::size_t> next_chunk { 0 };
+        std::atomic<std::size_t> first_failed_chunk { chunk_count };
+
+        auto const work = [&] {
+            for (std::size_t index; (index = next_chunk.fetch_add(1)) < chunk_count;) {
+                // Chunks after a failed one are discarded anyway
+                if (index > first_failed_chunk.load()) {
+                    continue;
+                }
+                auto&      chunk  = chunks[index];
+                auto const offset = index * chunk_size;
+                try {
+                    chunk.convert(
+                        deferred.subspan(offset, std::min(chunk_size, deferred.size() - offset)),
+                        offset);
                 }
-                else if (arg_it + 1 == command_line.end()) {
-                    throw exception(Parse_error_info::Kind::missing_argument, name, offset);
+                catch (...) {
+                    chunk.exception = std::current_exception();
                 }
-                else if (!it->parse(*++arg_it, it->value)) {
-                    throw exception(Parse_error_info::Kind::invalid_argument, *arg_it, 0);
+                if (chunk.failure.has_value() || chunk.exception != nullptr) {
+                    auto failed = first_failed_chunk.load();
+                    while (index < failed
+                           && !first_failed_chunk.compare_exchange_weak(failed, index)) {}
                 }
             }
+        };
+        {
+            std::vector<std::jthread> threads;
+            for (std::size_t thread = 1; thread < std::min(thread_count, chunk_count); ++thread) {
+                threads.emplace_back(work);
+            }
+            work();
+        }
+
+        for (std::size_t index = 0; index != chunk_count; ++index) {
+            auto& chunk = chunks[index];
+            for (auto const& [info, temporary] : chunk.temporaries) {
+                info->value_type->merge(temporary, storage(*info));
+            }
+            if (chunk.exception != nullptr) {
+                std::rethrow_exception(chunk.exception);
+            }
+            if (chunk.failure.has_value()) {
+                return chunk.failure;
+            }
+        }
+        return std::nullopt;
+    }
+
+    template <class Parameters, class Storage>
+    [[nodiscard]] auto parse_tokens_parallel(
+        Token_stream&     stream,
+        Parameters const& parameters,
+        Storage const&    storage,
+        std::size_t       thread_count) -> std::optional<cppargs::Parse_error>
+    {
+        if (thread_count == 0) {
+            thread_count = std::max(1U, std::thread::hardware_concurrency());
+        }
+        std::vector<Deferred> deferred;
+
+        // Conversion errors before the scanning error take precedence
+        auto const error = parse_tokens(
+            stream, parameters, Deferred_conversion { .stream = &stream, .deferred = &deferred });
+
+        if (auto const failure = convert_parallel<Storage>(deferred, storage, thread_count)) {
+            auto const& [info, value, token] = deferred[failure.value()];
+            return stream.make_error(
+                token, Kind::invalid_argument, value, info->value_type->choices);
+        }
+        return error;
+    }
+
+    // Reads parameters missing from the command line from the process environment
+    [[nodiscard]] auto with_environment(
+        cppargs::Parameters const& parameters, std::optional<cppargs::Parse_error> const& error)
+        -> std::optional<cppargs::Parse_error>
+    {
+        if (error.has_value() || !parameters.uses_environment()) {
+            return error;
+        }
+        return cppargs::try_parse_environment(cppargs::process_environment(), parameters);
+    }
+
+    // Returns whether no errors were added to `diagnostics`
+    [[nodiscard]] auto parse_collecting_errors(
+        Token_stream&              stream,
+        cppargs::Parameters const& parameters,
+        cppargs::Diagnostics&      diagnostics) -> bool
+    {
+        auto const count = diagnostics.errors().size();
+        auto const error = parse_tokens(
+            stream,
+            parameters,
+            Immediate_conversion { Parameter_storage {} },
+            nullptr,
+            No_observation {},
+            Collect_errors { .diagnostics = &diagnostics, .parameters = &parameters });
+
+        // Only an error from the environment is returned.
+        if (auto const environment_error = with_environment(parameters, error)) {
+            diagnostics.add(environment_error.value(), environment_error->suggestions(parameters));
+        }
+        return diagnostics.errors().size() == count;
+    }
+
+    [[nodiscard]] auto make_exception(
+        std::string_view const                  argument,
+        Kind const                              kind,
+        std::string_view const                  view,
+        std::span<std::string_view const> const choices = {}) -> cppargs::Exception
+    {
+        cppargs::Parse_error_info info {
+            .command_line = std::string(argument),
+            .kind         = kind,
+            .error_column = 1 + static_cast<std::size_t>(view.data() - argument.data()),
+            .error_width  = view.size(),
+            .source       = {},
+            .error_line   = 1,
+            .suggestions  = {},
+            .choices      = {},
+        };
+        cppargs::dtl::add_choices(info, view, choices);
+        return cppargs::Exception { std::move(info) };
+    }
+} // namespace
+
+auto cppargs::dtl::validate_command_line(Command_line const command_line) -> void
+{
+    if (!is_valid_command_line(command_line)) {
+        throw std::invalid_argument { "cppargs::parse: Invalid command line" };
+    }
+}
+
+auto cppargs::try_parse(Command_line const command_line, Parameters const& parameters)
+    -> std::optional<Parse_error>
+{
+    dtl::validate_command_line(command_line);
+    Token_stream stream(command_line, nullptr);
+    return with_environment(
+        parameters,
+        parse_tokens(stream, parameters, Immediate_conversion { Parameter_storage {} }));
+}
+
+auto cppargs::try_parse(
+    Command_line const command_line,
+    Parameters const&  parameters,
+    Response_files&    response_files) -> std::optional<Parse_error>
+{
+    dtl::validate_command_line(command_line);
+    Token_stream stream(command_line, &response_files);
+    return with_environment(
+        parameters,
+        parse_tokens(stream, parameters, Immediate_conversion { Parameter_storage {} }));
+}
+
+auto cppargs::try_parse(
+    Command_line const command_line,
+    Parameters const&  parameters,
+    Response_files&    response_files,
+    Parse_cache&       cache) -> std::optional<Parse_error>
+{
+    dtl::validate_command_line(command_line);
+    if (cache.restore(command_line, parameters, response_files)) {
+        return with_environment(parameters, std::nullopt);
+    }
+    Token_stream stream(command_line, &response_files);
+    auto const   error
+        = parse_tokens(stream, parameters, Immediate_conversion { Parameter_storage {} });
+    if (!error.has_value()) {
+        cache.store(command_line, parameters, response_files);
+    }
+    return with_environment(parameters, error);
+}
+
+auto cppargs::parse(Command_line const command_line, Parameters const& parameters) -> void
+{
+    if (auto const error = try_parse(command_line, parameters)) {
+        throw Exception(error->info(parameters));
+    }
+}
+
+auto cppargs::parse(
+    Command_line const command_line,
+    Parameters const&  parameters,
+    Response_files&    response_files) -> void
+{
+    if (auto const error = try_parse(command_line, parameters, response_files)) {
+        throw Exception(error->info(parameters));
+    }
+}
+
+auto cppargs::parse(
+    Command_line const command_line,
+    Parameters const&  parameters,
+    Response_files&    response_files,
+    Parse_cache&       cache) -> void
+{
+    if (auto const error = try_parse(command_line, parameters, response_files, cache)) {
+        throw Exception(error->info(parameters));
+    }
+}
+
+auto cppargs::try_parse(Command_string const& command_string, Parameters const& parameters)
+    -> std::optional<Parse_error>
+{
+    if (auto const quote = command_string.unterminated_quote()) {
+        return Parse_error(
+            {},
+            command_string.arguments().size(),
+            Kind::unterminated_quote,
+            command_string.source().text.substr(quote.value()),
+            &command_string.source());
+    }
+    Token_stream stream(command_string, nullptr);
+    return with_environment(
+        parameters,
+        parse_tokens(stream, parameters, Immediate_conversion { Parameter_storage {} }));
+}
+
+auto cppargs::parse(Command_string const& command_string, Parameters const& parameters) -> void
+{
+    if (auto const error = try_parse(command_string, parameters)) {
+        throw Exception(error->info(parameters));
+    }
+}
+
+auto cppargs::try_parse_parallel(
+    Command_line const command_line,
+    Parameters const&  parameters,
+    std::size_t const  thread_count) -> std::optional<Parse_error>
+{
+    dtl::validate_command_line(command_line);
+    Token_stream stream(command_line, nullptr);
+    return with_environment(
+        parameters, parse_tokens_parallel(stream, parameters, Parameter_storage {}, thread_count));
+}
+
+auto cppargs::parse_parallel(
+    Command_line const command_line,
+    Parameters const&  parameters,
+    std::size_t const  thread_count) -> void
+{
+    if (auto const error = try_parse_parallel(command_line, parameters, thread_count)) {
+        throw Exception(error->info(parameters));
+    }
+}
+
+auto cppargs::try_parse(Command_line const command_line, Schema const& schema, Values& values)
+    -> std::optional<Parse_error>
+{
+    assert(&values.schema() == &schema);
+    dtl::validate_command_line(command_line);
+    Token_stream stream(command_line, nullptr);
+    return parse_tokens(
+        stream,
+        schema,
+        Immediate_conversion { Values_storage { .schema = &schema, .values = &values } });
+}
+
+auto cppargs::parse(Command_line const command_line, Schema const& schema, Values& values) -> void
+{
+    if (auto const error = try_parse(command_line, schema, values)) {
+        throw Exception(error->info(schema));
+    }
+}
+
+auto cppargs::Subcommands::try_parse(Command_line const command_line, Parameters const& global)
+    -> std::optional<Parse_error>
+{
+    dtl::validate_command_line(command_line);
+    Token_stream         stream(command_line, nullptr);
+    std::optional<Token> name;
+
+    m_selected = nullptr;
+    m_parameters.reset();
+
+    Immediate_conversion const convert { Parameter_storage {} };
+    if (auto const error = parse_tokens(stream, global, convert, &name)) {
+        return error;
+    }
+    if (!name.has_value()) {
+        return stream.make_end_error(Kind::missing_subcommand);
+    }
+    auto const entry = find(name->string);
+    if (entry == nullptr) {
+        return stream.make_error(
+            name.value(), Kind::unrecognized_subcommand, name->string, m_names);
+    }
+
+    m_parameters.emplace(m_resource);
+    entry->build(m_parameters.value());
+    m_selected = entry;
+
+    Token_stream rest(command_line, nullptr, name->argument + 1);
+    if (auto const error = parse_tokens(rest, m_parameters.value(), convert)) {
+        return error;
+    }
+    if (auto const error = with_environment(global, std::nullopt)) {
+        return error;
+    }
+    return with_environment(m_parameters.value(), std::nullopt);
+}
+
+auto cppargs::Subcommands::try_parse(Command_line const command_line)
+    -> std::optional<Parse_error>
+{
+    return try_parse(command_line, Parameters());
+}
+
+auto cppargs::Subcommands::parse(Command_line const command_line, Parameters const& global)
+    -> void
+{
+    if (auto const error = try_parse(command_line, global)) {
+        // Errors after the name of the subcommand come from its parameters
+        throw Exception(error->info(m_selected != nullptr ? m_parameters.value() : global));
+    }
+}
+
+auto cppargs::Subcommands::parse(Command_line const command_line) -> void
+{
+    parse(command_line, Parameters());
+}
+
+auto cppargs::parse_all(
+    Command_line const command_line, Parameters const& parameters, Diagnostics& diagnostics)
+    -> bool
+{
+    dtl::validate_command_line(command_line);
+    Token_stream stream(command_line, nullptr);
+    return parse_collecting_errors(stream, parameters, diagnostics);
+}
+
+auto cppargs::parse_all(
+    Command_line const command_line,
+    Parameters const&  parameters,
+    Response_files&    response_files,
+    Diagnostics&       diagnostics) -> bool
+{
+    dtl::validate_command_line(command_line);
+    Token_stream stream(command_line, &response_files);
+    return parse_collecting_errors(stream, parameters, diagnostics);
+}
+
+auto cppargs::try_parse(
+    Command_line const command_line, Parameters const& parameters, Parse_observer& observer)
+    -> std::optional<Parse_error>
+{
+    dtl::validate_command_line(command_line);
+    auto const   start = Clock::now();
+    Observation  observation(observer, parameters.resource());
+    Token_stream stream(command_line, nullptr);
+
+    auto const error = with_environment(
+        parameters,
+        parse_tokens(
+            stream,
+            Observed_parameters { .parameters = &parameters, .observation = &observation },
+            Observed_conversion {
+                .conversion  = Immediate_conversion { Parameter_storage {} },
+                .observation = &observation,
+            },
+            nullptr,
+            observation));
+    observation.finish(error, Clock::now() - start, {});
+    return error;
+}
+
+auto cppargs::parse(
+    Command_line const command_line, Parameters const& parameters, Parse_observer& observer)
+    -> void
+{
+    // The exception is built before the observer is told how long that took.
+    struct Deferred_observer : Parse_observer {
+        Parse_observer* observer {};
+        Parse_stats     stats;
+
+        auto on_token(Token_event const& event) -> void override
+        {
+            observer->on_token(event);
         }
-        else {
-            throw exception(Parse_error_info::Kind::positional_argument, string, 0);
+
+        auto on_finish(Parse_stats const& totals) -> void override
+        {
+            stats = totals;
         }
+    };
+
+    Deferred_observer deferred;
+    deferred.observer = &observer;
+
+    auto const start = Clock::now();
+    auto const error = try_parse(command_line, parameters, deferred);
+    if (!error.has_value()) {
+        observer.on_finish(deferred.stats);
+        return;
     }
+    auto const exception_start    = Clock::now();
+    auto const exception          = Exception(error->info(parameters));
+    auto const end                = Clock::now();
+    deferred.stats.exception_time = end - exception_start;
+    deferred.stats.total_time     = end - start;
+    observer.on_finish(deferred.stats);
+    throw exception;
+}
+
+cppargs::Parser::Parser(Parameters const& parameters) noexcept : m_parameters(&parameters) {}
+
+auto cppargs::Parser::feed(std::string_view const argument) -> void
+{
+    if (m_pending == nullptr && (m_options_ended || argument == "--" || is_positional(argument))) {
+        if (!m_options_ended && argument == "--") {
+            m_options_ended = true;
+            return;
+        }
+        auto const info
+            = positional_parameter(m_parameters->positional_parameters(), m_positional_count);
+        if (info == nullptr) {
+            throw make_exception(argument, Kind::positional_argument, argument);
+        }
+        if (!info->parse(argument, info->value)) {
+            throw make_exception(
+                argument, Kind::invalid_argument, argument, info->value_type->choices);
+        }
+        ++m_positional_count;
+        return;
+    }
+    auto const step = parse_argument(
+        *m_parameters, Immediate_conversion { Parameter_storage {} }, m_pending, argument);
+    if (step.error.has_value()) {
+        m_pending = nullptr;
+        throw make_exception(argument, step.error.value(), step.error_view, step.error_choices);
+    }
+    m_pending = step.pending;
+    if (m_pending != nullptr) {
+        m_pending_argument.assign(argument);
+        m_pending_name_offset
+            = static_cast<std::size_t>(step.pending_name.data() - argument.data());
+    }
+}
+
+auto cppargs::Parser::finish() -> void
+{
+    auto const pending          = std::exchange(m_pending, nullptr);
+    auto const positional_count = std::exchange(m_positional_count, 0);
+    m_options_ended             = false;
+
+    if (pending != nullptr) {
+        std::string_view const argument = m_pending_argument;
+        throw make_exception(
+            argument, Kind::missing_argument, argument.substr(m_pending_name_offset));
+    }
+    if (positional_count < m_parameters->positional_parameters().required) {
+        throw make_exception({}, Kind::missing_positional_argument, {});
+    }
+}
+
+auto cppargs::Parser::is_pending() const noexcept -> bool
+{
+    return m_pending != nullptr;
 }
 
 auto cppargs::parse(int const argc, char const* const* const argv, Parameters const& parameters)
@@ -118,3 +1130,11 @@ auto cppargs::parse(int const argc, char const* const* const argv, Parameters co
     assert(argv != nullptr);
     return parse(Command_line(argv, argv + argc), parameters);
 }
+
+auto cppargs::try_parse(int const argc, char const* const* const argv, Parameters const& parameters)
+    -> std::optional<Parse_error>
+{
+    assert(argc != 0);
+    assert(argv != nullptr);
+    return try_parse(Command_line(argv, argv + argc), parameters);
+}
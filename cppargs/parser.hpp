@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cppargs.hpp>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace cppargs {
+
+    // Parses arguments one at a time, for example as they arrive over a pipe. An option whose
+    // value has not been fed yet is remembered between calls. Errors are thrown as `Exception`,
+    // whose command line is the offending argument.
+    class Parser {
+        Parameters const*          m_parameters;
+        dtl::Parameter_info const* m_pending {};
+        std::string                m_pending_argument;
+        std::size_t                m_pending_name_offset {};
+        std::size_t                m_positional_count {};
+        bool                       m_options_ended {};
+    public:
+        explicit Parser(Parameters const& parameters) noexcept;
+
+        // Positional arguments are parsed immediately. Arguments after `--` are always
+        // positional, as trailing arguments can only be taken from a command line.
+        auto feed(std::string_view argument) -> void;
+
+        // Reports an option still waiting for its value or a missing positional argument, and
+        // resets the parser
+        auto finish() -> void;
+
+        // Whether the next argument will be taken as the value of an option
+        [[nodiscard]] auto is_pending() const noexcept -> bool;
+    };
+
+} // namespace cppargs
@@ -0,0 +1,103 @@
+#include <cppargs.hpp>
+#include <filesystem>
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define CPPARGS_HAS_MMAP
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+struct cppargs::Response_files::Mapping {
+    Source_file           file;
+    std::filesystem::path canonical_path;
+#ifdef CPPARGS_HAS_MMAP
+    void*       address = MAP_FAILED;
+    std::size_t size {};
+
+    ~Mapping()
+    {
+        if (address != MAP_FAILED) {
+            ::munmap(address, size);
+        }
+    }
+#else
+    std::string contents;
+#endif
+
+    // Returns false if the file could not be read
+    auto load() -> bool
+    {
+#ifdef CPPARGS_HAS_MMAP
+        int const descriptor = ::open(canonical_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor == -1) {
+            return false;
+        }
+        struct stat status {};
+        bool const  ok = ::fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode);
+        if (ok && status.st_size != 0) {
+            size    = static_cast<std::size_t>(status.st_size);
+            address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        }
+        ::close(descriptor);
+        if (!ok || (size != 0 && address == MAP_FAILED)) {
+            return false;
+        }
+        if (size != 0) {
+            file.text = std::string_view(static_cast<char const*>(address), size);
+        }
+        return true;
+#else
+        std::ifstream stream(canonical_path, std::ios::binary);
+        if (!stream) {
+            return false;
+        }
+        contents.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        file.text = contents;
+        return !stream.bad();
+#endif
+    }
+};
+
+cppargs::Response_files::Response_files() = default;
+
+cppargs::Response_files::Response_files(Response_files&&) noexcept = default;
+
+auto cppargs::Response_files::operator=(Response_files&&) noexcept -> Response_files& = default;
+
+cppargs::Response_files::~Response_files() = default;
+
+auto cppargs::Response_files::open(std::string_view const path) -> Source_file const*
+{
+    std::error_code ec;
+    auto            canonical_path = std::filesystem::canonical(std::filesystem::path(path), ec);
+    if (ec) {
+        return nullptr;
+    }
+    for (auto const& mapping : m_mappings) {
+        if (mapping->canonical_path == canonical_path) {
+            return &mapping->file;
+        }
+    }
+    auto mapping            = std::make_unique<Mapping>();
+    mapping->file.path      = std::string(path);
+    mapping->canonical_path = std::move(canonical_path);
+    if (!mapping->load()) {
+        return nullptr;
+    }
+    return &m_mappings.emplace_back(std::move(mapping))->file;
+}
+
+auto cppargs::Response_files::size() const noexcept -> std::size_t
+{
+    return m_mappings.size();
+}
+
+auto cppargs::Response_files::file(std::size_t const index) const noexcept -> Source_file const&
+{
+    return m_mappings[index]->file;
+}
@@ -0,0 +1,92 @@
+#include <cppargs.hpp>
+#include <schema.hpp>
+
+cppargs::Values::Values(Schema const& schema, std::pmr::memory_resource* const resource)
+    : m_schema(&schema)
+    , m_resource(resource)
+{
+    if (schema.m_size != 0) {
+        m_data = static_cast<std::byte*>(resource->allocate(schema.m_size, schema.m_alignment));
+    }
+    for (auto const& layout : schema.m_layouts) {
+        layout.type->construct(m_data + layout.offset, resource);
+    }
+}
+
+cppargs::Values::~Values()
+{
+    for (auto const& layout : m_schema->m_layouts) {
+        layout.type->destroy(m_data + layout.offset);
+    }
+    if (m_data != nullptr) {
+        m_resource->deallocate(m_data, m_schema->m_size, m_schema->m_alignment);
+    }
+}
+
+auto cppargs::Values::reset() -> void
+{
+    for (auto const& layout : m_schema->m_layouts) {
+        layout.type->reset(m_data + layout.offset);
+    }
+}
+
+auto cppargs::Values::schema() const noexcept -> Schema const&
+{
+    return *m_schema;
+}
+
+auto cppargs::Values::slot(std::size_t const index) noexcept -> void*
+{
+    return m_data + m_schema->m_layouts[index].offset;
+}
+
+auto cppargs::Values::data() const noexcept -> std::byte const*
+{
+    return m_data;
+}
+
+auto cppargs::Schema::help_string() const -> std::string
+{
+    return m_parameters.help_string();
+}
+
+auto cppargs::Schema::help_to(std::FILE* const file, std::size_t const width) const -> void
+{
+    m_parameters.help_to(file, width);
+}
+
+auto cppargs::Schema::info_span() const noexcept -> std::span<dtl::Parameter_info const>
+{
+    return m_parameters.info_span();
+}
+
+auto cppargs::Schema::find(std::string_view const long_name) const -> dtl::Parameter_info const*
+{
+    return m_parameters.find(long_name);
+}
+
+auto cppargs::Schema::find(char const short_name) const noexcept -> dtl::Parameter_info const*
+{
+    return m_parameters.find(short_name);
+}
+
+auto cppargs::Schema::long_names() const -> std::span<std::string_view const>
+{
+    return m_parameters.long_names();
+}
+
+auto cppargs::Schema::allow_abbreviations(bool const allow) -> void
+{
+    m_parameters.allow_abbreviations(allow);
+}
+
+auto cppargs::Schema::match(std::string_view const long_name) const -> dtl::Parameter_info const*
+{
+    return m_parameters.match(long_name);
+}
+
+auto cppargs::Schema::suggest(std::string_view const name, std::size_t const count) const
+    -> std::vector<std::string_view>
+{
+    return m_parameters.suggest(name, count);
+}
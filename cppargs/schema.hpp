@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cppargs.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cppargs::dtl {
+
+    // Location of a value stored in a `Values` buffer
+    struct Value_layout {
+        Value_type const* type {};
+        std::size_t       offset {};
+    };
+
+} // namespace cppargs::dtl
+
+namespace cppargs {
+
+    class Schema;
+
+    // Values produced by parsing against a `Schema`, stored in one contiguous buffer allocated
+    // from the given memory resource. `reset` clears the values for reuse. Must not outlive
+    // its schema.
+    class Values {
+        Schema const*              m_schema;
+        std::pmr::memory_resource* m_resource;
+        std::byte*                 m_data {};
+    public:
+        explicit Values(
+            Schema const&              schema,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        Values(Values const&)                    = delete;
+        auto operator=(Values const&) -> Values& = delete;
+
+        ~Values();
+
+        auto reset() -> void;
+
+        [[nodiscard]] auto schema() const noexcept -> Schema const&;
+
+        // Storage of the parameter at `index` in the schema
+        [[nodiscard]] auto slot(std::size_t index) noexcept -> void*;
+
+        [[nodiscard]] auto data() const noexcept -> std::byte const*;
+    };
+
+    // Handle used to access the value of a `Schema` parameter within some `Values`
+    template <class T>
+    class Key {
+        std::size_t m_offset {};
+
+        explicit Key(std::size_t const offset) noexcept : m_offset(offset) {}
+
+        [[nodiscard]] auto slot(Values const& values) const noexcept -> dtl::Slot<T> const&
+        {
+            return *std::launder(reinterpret_cast<dtl::Slot<T> const*>(values.data() + m_offset));
+        }
+
+        friend class Schema;
+    public:
+        [[nodiscard]] auto value(Values const& values) const noexcept -> T const&
+        {
+            return slot(values).value.value();
+        }
+
+        [[nodiscard]] auto has_value(Values const& values) const noexcept -> bool
+        {
+            return slot(values).value.has_value();
+        }
+    };
+
+    template <class T>
+    class Key<Incremental<T>> {
+        std::size_t m_offset {};
+
+        explicit Key(std::size_t const offset) noexcept : m_offset(offset) {}
+
+        friend class Schema;
+    public:
+        [[nodiscard]] auto values(Values const& values) const noexcept -> std::span<T const>
+        {
+            return *std::launder(
+                reinterpret_cast<std::pmr::vector<T> const*>(values.data() + m_offset));
+        }
+    };
+
+    template <class T, char separator>
+    class Key<List<T, separator>> {
+        std::size_t m_offset {};
+
+        explicit Key(std::size_t const offset) noexcept : m_offset(offset) {}
+
+        friend class Schema;
+    public:
+        [[nodiscard]] auto values(Values const& values) const noexcept -> std::span<T const>
+        {
+            return *std::launder(
+                reinterpret_cast<std::pmr::vector<T> const*>(values.data() + m_offset));
+        }
+    };
+
+    // Parameter schema that does not own any values. Arguments are parsed into a separate
+    // `Values` object, so one schema can be shared by any number of threads, each parsing into
+    // its own `Values`. The schema must not be modified while it is being used for parsing.
+    class Schema {
+        Parameters                     m_parameters;
+        std::vector<dtl::Value_layout> m_layouts;
+        std::size_t                    m_size {};
+        std::size_t                    m_alignment = 1;
+        friend class Values;
+    public:
+        [[nodiscard]] auto help_string() const -> std::string;
+
+        template <std::output_iterator<char> Output>
+        auto help_to(Output output, std::size_t const width = 0) const -> Output
+        {
+            return m_parameters.help_to(std::move(output), width);
+        }
+
+        auto help_to(std::FILE* file, std::size_t width = 0) const -> void;
+
+        [[nodiscard]] auto info_span() const noexcept -> std::span<dtl::Parameter_info const>;
+
+        [[nodiscard]] auto find(std::string_view long_name) const -> dtl::Parameter_info const*;
+        [[nodiscard]] auto find(char short_name) const noexcept -> dtl::Parameter_info const*;
+
+        [[nodiscard]] auto long_names() const -> std::span<std::string_view const>;
+
+        auto allow_abbreviations(bool allow = true) -> void;
+
+        [[nodiscard]] auto match(std::string_view long_name) const -> dtl::Parameter_info const*;
+
+        [[nodiscard]] auto suggest(std::string_view name, std::size_t count = 3) const
+            -> std::vector<std::string_view>;
+
+        template <argument T = Unit>
+        [[nodiscard]] auto add(
+            std::optional<char> short_name,
+            std::string_view    long_name,
+            std::string_view    description = {}) -> Key<T>;
+
+        template <argument T = Unit>
+        [[nodiscard]] auto add(
+            std::string_view const long_name, std::string_view const description = {}) -> Key<T>
+        {
+            return add<T>(std::nullopt, long_name, description);
+        }
+    };
+
+    // Parses into `values`, which must have been created for `schema`. Safe to call concurrently
+    // with the same schema, as long as each thread uses different values.
+    auto parse(Command_line command_line, Schema const& schema, Values& values) -> void;
+
+    [[nodiscard]] auto try_parse(Command_line command_line, Schema const& schema, Values& values)
+        -> std::optional<Parse_error>;
+
+} // namespace cppargs
+
+template <cppargs::argument T>
+auto cppargs::Schema::add(
+    std::optional<char> const short_name,
+    std::string_view const    long_name,
+    std::string_view const    description) -> Key<T>
+{
+    auto const& type = dtl::value_type_of<T>;
+
+    auto const offset = (m_size + type.alignment - 1) / type.alignment * type.alignment;
+    m_size            = offset + type.size;
+    m_alignment       = type.alignment > m_alignment ? type.alignment : m_alignment;
+
+    m_layouts.push_back({ .type = &type, .offset = offset });
+    m_parameters.push(
+        dtl::make_parameter_info<T>(nullptr, short_name, long_name),
+        dtl::make_parameter_help<T>(description));
+    return Key<T>(offset);
+}
+
+// Like the instantiations for `Parameters` in cppargs.hpp. `prefix` is either `extern` or empty.
+#define CPPARGS_DTL_INSTANTIATE_SCHEMA(prefix, T)                            \
+    prefix template auto cppargs::Schema::add<T>(                            \
+        std::optional<char>, std::string_view, std::string_view)             \
+        -> cppargs::Key<T>;
+
+#define CPPARGS_DTL_EXTERN_SCHEMA(T)                                         \
+    CPPARGS_DTL_INSTANTIATE_SCHEMA(extern, T)                                \
+    CPPARGS_DTL_INSTANTIATE_SCHEMA(extern, cppargs::Incremental<T>)
+
+#ifndef CPPARGS_NO_EXTERN_TEMPLATES
+CPPARGS_DTL_FOR_EACH_ARGUMENT(CPPARGS_DTL_EXTERN_SCHEMA)
+CPPARGS_DTL_INSTANTIATE_SCHEMA(extern, bool)
+#endif
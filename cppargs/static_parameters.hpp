@@ -0,0 +1,317 @@
+#pragma once
+
+#include <cppargs.hpp>
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+
+namespace cppargs {
+
+    // String literal usable as a template argument
+    template <std::size_t length>
+    struct Fixed_string {
+        char characters[length] {};
+
+        consteval Fixed_string(char const (&string)[length])
+        {
+            std::copy_n(string, length, characters);
+        }
+
+        [[nodiscard]] constexpr auto view() const noexcept -> std::string_view
+        {
+            return std::string_view(characters, length - 1);
+        }
+    };
+
+    // Compile-time description of a parameter. A null short name means there is none.
+    template <argument T, std::size_t name_length, std::size_t description_length>
+    struct Option {
+        using Type = T;
+        char                             short_name {};
+        Fixed_string<name_length>        long_name;
+        Fixed_string<description_length> description;
+    };
+
+    template <argument T = Unit, std::size_t name_length, std::size_t description_length = 1>
+    consteval auto option(
+        char const short_name,
+        char const (&long_name)[name_length],
+        char const (&description)[description_length] = "")
+        -> Option<T, name_length, description_length>
+    {
+        return { short_name, long_name, description };
+    }
+
+    template <argument T = Unit, std::size_t name_length, std::size_t description_length = 1>
+    consteval auto option(
+        char const (&long_name)[name_length], char const (&description)[description_length] = "")
+        -> Option<T, name_length, description_length>
+    {
+        return { '\0', long_name, description };
+    }
+
+    // Parameter value stored inline, accessed like `Parameter<T>`
+    template <class T>
+    class Static_parameter {
+        dtl::Slot<T> m_value;
+        template <auto...>
+        friend class Static_parameters;
+    public:
+        [[nodiscard]] auto value() const noexcept -> T const&
+        {
+            return m_value.value.value();
+        }
+
+        [[nodiscard]] auto has_value() const noexcept -> bool
+        {
+            return m_value.value.has_value();
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept
+        {
+            return has_value();
+        }
+    };
+
+    template <class T>
+    class Static_parameter<Incremental<T>> {
+        std::pmr::vector<T> m_value;
+        template <auto...>
+        friend class Static_parameters;
+    public:
+        [[nodiscard]] auto values() const noexcept -> std::span<T const>
+        {
+            return m_value;
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept
+        {
+            return !values().empty();
+        }
+    };
+
+    template <class T, char separator>
+    class Static_parameter<List<T, separator>> : public Static_parameter<Incremental<T>> {};
+
+} // namespace cppargs
+
+namespace cppargs::dtl {
+
+    struct Static_name {
+        std::string_view name;
+        std::size_t      index {};
+    };
+
+} // namespace cppargs::dtl
+
+namespace cppargs {
+
+    // Parameter schema resolved entirely at compile time. Values are stored inline, names are
+    // looked up in tables computed by the compiler, and each argument is parsed with a direct
+    // call to `Argument<T>::parse` instead of going through a function pointer. Duplicate long
+    // or short names fail compilation.
+    template <auto... options>
+    class Static_parameters {
+        static constexpr std::size_t size = sizeof...(options);
+
+        template <std::size_t index>
+        using Type_at =
+            typename std::tuple_element_t<index, std::tuple<decltype(options)...>>::Type;
+
+        static constexpr std::array<bool, size> flags {
+            std::is_same_v<typename decltype(options)::Type, Unit>...,
+        };
+
+        static constexpr std::array<std::span<std::string_view const>, size> choices {
+            dtl::choices_of<typename decltype(options)::Type>()...,
+        };
+
+        static constexpr auto long_names = [] {
+            std::array<std::string_view, size> const names { options.long_name.view()... };
+            std::array<dtl::Static_name, size>       table {};
+            for (std::size_t index = 0; index != size; ++index) {
+                table[index] = { names[index], index };
+            }
+            std::ranges::sort(table, {}, &dtl::Static_name::name);
+            return table;
+        }();
+
+        static constexpr auto short_names = [] {
+            std::array<char, size> const   names { options.short_name... };
+            std::array<std::uint32_t, 256> table {}; // Index plus one
+            for (std::size_t index = 0; index != size; ++index) {
+                if (names[index] != '\0') {
+                    table[static_cast<unsigned char>(names[index])] = index + 1;
+                }
+            }
+            return table;
+        }();
+
+        static constexpr bool unique_short_names = [] {
+            std::array<char, size> const names { options.short_name... };
+            std::array<bool, 256>        taken {};
+            for (char const name : names) {
+                if (name != '\0' && std::exchange(taken[static_cast<unsigned char>(name)], true)) {
+                    return false;
+                }
+            }
+            return true;
+        }();
+
+        static_assert(
+            std::ranges::adjacent_find(long_names, {}, &dtl::Static_name::name) == long_names.end(),
+            "Static_parameters: Duplicate long name");
+        static_assert(unique_short_names, "Static_parameters: Duplicate short name");
+
+        std::tuple<Static_parameter<typename decltype(options)::Type>...> m_parameters;
+    public:
+        // Sentinel returned by `find` when no parameter has the given name
+        static constexpr std::size_t npos = size;
+
+        template <Fixed_string long_name>
+        [[nodiscard]] auto get() const noexcept -> auto const&
+        {
+            constexpr auto it
+                = std::ranges::find(long_names, long_name.view(), &dtl::Static_name::name);
+            static_assert(it != long_names.end(), "Static_parameters: Unknown long name");
+            return std::get<it->index>(m_parameters);
+        }
+
+        [[nodiscard]] static auto find(std::string_view const long_name) noexcept -> std::size_t
+        {
+            auto const it
+                = std::ranges::lower_bound(long_names, long_name, {}, &dtl::Static_name::name);
+            return it != long_names.end() && it->name == long_name ? it->index : npos;
+        }
+
+        [[nodiscard]] static auto find(char const short_name) noexcept -> std::size_t
+        {
+            auto const slot = short_names[static_cast<unsigned char>(short_name)];
+            return slot == 0 ? npos : slot - 1;
+        }
+
+        [[nodiscard]] static auto is_flag(std::size_t const index) noexcept -> bool
+        {
+            return flags[index];
+        }
+
+        // The valid arguments of the parameter at `index`, if it only takes a fixed set of them
+        [[nodiscard]] static auto choices_of(std::size_t const index) noexcept
+            -> std::span<std::string_view const>
+        {
+            return choices[index];
+        }
+
+        // Parses `string` as the argument of the parameter at `index`
+        auto parse(std::size_t const index, std::string_view const string) -> bool
+        {
+            return [&]<std::size_t... indices>(std::index_sequence<indices...>) {
+                bool result = false;
+                (void)((index == indices
+                        && (result = dtl::Parse<Type_at<indices>>::parse(
+                                string, &std::get<indices>(m_parameters).m_value),
+                            true))
+                       || ...);
+                return result;
+            }(std::make_index_sequence<size> {});
+        }
+    };
+
+    template <auto... options>
+    [[nodiscard]] auto try_parse(
+        Command_line const command_line, Static_parameters<options...>& parameters)
+        -> std::optional<Parse_error>
+    {
+        using Parameters = Static_parameters<options...>;
+
+        dtl::validate_command_line(command_line);
+
+        for (auto arg_it = command_line.begin() + 1; arg_it != command_line.end(); ++arg_it) {
+            std::string_view const string = *arg_it;
+
+            auto const error = [&](Parse_error_info::Kind const            kind,
+                                   std::string_view const            view,
+                                   std::span<std::string_view const> choices = {}) {
+                auto const argument = static_cast<std::size_t>(arg_it - command_line.begin());
+                return Parse_error(command_line, argument, kind, view, nullptr, choices);
+            };
+
+            if (string != "--" && string.starts_with("--")) {
+                auto const name  = string.substr(2);
+                auto const index = Parameters::find(name);
+
+                if (index == Parameters::npos) {
+                    return error(Parse_error_info::Kind::unrecognized_option, name);
+                }
+                else if (Parameters::is_flag(index)) {
+                    (void)parameters.parse(index, {});
+                }
+                else if (arg_it + 1 == command_line.end()) {
+                    return error(Parse_error_info::Kind::missing_argument, name);
+                }
+                else if (!parameters.parse(index, *++arg_it)) {
+                    return error(
+                        Parse_error_info::Kind::invalid_argument,
+                        *arg_it,
+                        Parameters::choices_of(index));
+                }
+            }
+            else if (string != "--" && string != "-" && string.starts_with('-')) {
+                for (auto char_it = string.begin() + 1; char_it != string.end(); ++char_it) {
+                    auto const name  = std::string_view(char_it, 1);
+                    auto const index = Parameters::find(*char_it);
+
+                    if (index == Parameters::npos) {
+                        return error(Parse_error_info::Kind::unrecognized_option, name);
+                    }
+                    else if (Parameters::is_flag(index)) {
+                        (void)parameters.parse(index, {});
+                    }
+                    else if (char_it + 1 != string.end()) {
+                        std::string_view const argument(char_it + 1, string.end());
+                        if (parameters.parse(index, argument)) {
+                            break;
+                        }
+                        return error(
+                            Parse_error_info::Kind::invalid_argument,
+                            argument,
+                            Parameters::choices_of(index));
+                    }
+                    else if (arg_it + 1 == command_line.end()) {
+                        return error(Parse_error_info::Kind::missing_argument, name);
+                    }
+                    else if (!parameters.parse(index, *++arg_it)) {
+                        return error(
+                            Parse_error_info::Kind::invalid_argument,
+                            *arg_it,
+                            Parameters::choices_of(index));
+                    }
+                }
+            }
+            else {
+                return error(Parse_error_info::Kind::positional_argument, string);
+            }
+        }
+        return std::nullopt;
+    }
+
+    template <auto... options>
+    auto parse(Command_line const command_line, Static_parameters<options...>& parameters) -> void
+    {
+        if (auto const error = try_parse(command_line, parameters)) {
+            throw Exception(error.value());
+        }
+    }
+
+    template <auto... options>
+    auto parse(
+        int const                      argc,
+        char const* const* const       argv,
+        Static_parameters<options...>& parameters) -> void
+    {
+        assert(argc != 0);
+        assert(argv != nullptr);
+        return parse(Command_line(argv, argv + argc), parameters);
+    }
+
+} // namespace cppargs
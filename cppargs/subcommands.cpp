@@ -0,0 +1,68 @@
+#include <cppargs.hpp>
+#include <subcommands.hpp>
+#include <algorithm>
+#include <format>
+
+cppargs::Subcommands::Subcommands(std::pmr::memory_resource* const resource)
+    : m_resource(resource)
+{}
+
+auto cppargs::Subcommands::find(std::string_view const name) const noexcept -> Entry const*
+{
+    // Only one lookup is made per parse, which does not pay for building an index.
+    auto const it = std::ranges::find(m_entries, name, &Entry::name);
+    return it == m_entries.end() ? nullptr : &*it;
+}
+
+auto cppargs::Subcommands::add(
+    std::string_view const name, std::string_view const description, Build build) -> void
+{
+    if (find(name) != nullptr) {
+        throw std::invalid_argument { "cppargs::Subcommands::add: Name already taken" };
+    }
+    m_entries.push_back({ .name = name, .description = description, .build = std::move(build) });
+    m_names.push_back(name);
+}
+
+auto cppargs::Subcommands::selected() const noexcept -> std::string_view
+{
+    return m_selected == nullptr ? std::string_view() : m_selected->name;
+}
+
+auto cppargs::Subcommands::parameters() const noexcept -> Parameters const*
+{
+    return m_parameters.has_value() ? &m_parameters.value() : nullptr;
+}
+
+auto cppargs::Subcommands::help_string() const -> std::string
+{
+    std::size_t max_length {};
+    for (auto const& entry : m_entries) {
+        max_length = std::max(max_length, entry.name.size());
+    }
+    std::string string;
+    for (auto const& [name, description, build] : m_entries) {
+        std::format_to(
+            std::back_inserter(string),
+            "\t{:{}} : {}\n",
+            name,
+            max_length,
+            description.empty() ? "..." : description);
+    }
+    return string;
+}
+
+auto cppargs::Subcommands::help_string(std::string_view const name) const -> std::string
+{
+    auto const entry = find(name);
+    if (entry == nullptr) {
+        throw std::invalid_argument { "cppargs::Subcommands::help_string: Unknown subcommand" };
+    }
+    if (entry == m_selected) {
+        return m_parameters->help_string();
+    }
+    // Handles stored by `build` may outlive the parameters, so they share the usual resource.
+    Parameters parameters(m_resource);
+    entry->build(parameters);
+    return parameters.help_string();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cppargs.hpp>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cppargs {
+
+    // Selects a subcommand by the first positional argument of the command line. Options before
+    // it are parsed with the given global parameters, and the arguments after it with the
+    // parameters of the subcommand. These are only built once the subcommand is selected, by the
+    // function given to `add`, so unused subcommands cost nothing but their registration.
+    class Subcommands {
+    public:
+        using Build = std::function<auto(Parameters&)->void>;
+    private:
+        struct Entry {
+            std::string_view name;
+            std::string_view description;
+            Build            build;
+        };
+
+        std::pmr::memory_resource*    m_resource;
+        std::vector<Entry>            m_entries;
+        std::vector<std::string_view> m_names; // Choices of an unrecognized subcommand
+        std::optional<Parameters>     m_parameters;
+        Entry const*                  m_selected {};
+
+        [[nodiscard]] auto find(std::string_view name) const noexcept -> Entry const*;
+    public:
+        Subcommands() : Subcommands(std::pmr::get_default_resource()) {}
+
+        // The parameters of subcommands are allocated from `resource`
+        explicit Subcommands(std::pmr::memory_resource* resource);
+
+        // `name` and `description` must outlive this object. Throws `std::invalid_argument` if
+        // the name is already taken. `build` is called when the subcommand is selected, and
+        // again by `help_string(name)` while it is not. Handles it stores are rebound each time,
+        // so they must not be shared with other subcommands.
+        auto add(std::string_view name, std::string_view description, Build build) -> void;
+
+        // Selects the subcommand, builds its parameters, and parses the rest of the command line
+        // with them. Replaces the parameters of a previously selected subcommand. An
+        // unrecognized subcommand is reported with the names of the others as choices.
+        [[nodiscard]] auto try_parse(Command_line command_line, Parameters const& global)
+            -> std::optional<Parse_error>;
+
+        [[nodiscard]] auto try_parse(Command_line command_line) -> std::optional<Parse_error>;
+
+        auto parse(Command_line command_line, Parameters const& global) -> void;
+        auto parse(Command_line command_line) -> void;
+
+        // The name of the selected subcommand, or an empty string
+        [[nodiscard]] auto selected() const noexcept -> std::string_view;
+
+        // The parameters of the selected subcommand, or null
+        [[nodiscard]] auto parameters() const noexcept -> Parameters const*;
+
+        // Lists the subcommands and their descriptions
+        [[nodiscard]] auto help_string() const -> std::string;
+
+        // Help text of the named subcommand. Unless it is the selected one, its parameters are
+        // built for the occasion by calling its build function, which rebinds the handles that
+        // function stores to parameters that hold no values. Throws `std::invalid_argument` if
+        // there is no such subcommand.
+        [[nodiscard]] auto help_string(std::string_view name) const -> std::string;
+    };
+
+} // namespace cppargs
@@ -0,0 +1,182 @@
+#include <cppargs.hpp>
+#include <suggestions.hpp>
+#include <algorithm>
+
+// Edit distances are computed with the bit-vector algorithm of Myers, in the formulation of Hyyrö
+// for the distance between whole strings. Bit `i` of each vector describes the difference
+// between rows `i` and `i + 1` of the current column of the dynamic programming matrix.
+
+cppargs::dtl::Name_ranking::Name_ranking(std::string_view const name, std::size_t const count)
+    : m_length(name.size())
+    , m_count(name.size() <= 64 ? count : 0) // Longer names get no suggestions.
+{
+    // Allow roughly one edit per three characters, but never replacing the whole name.
+    m_bound = m_length == 0 ? 0 : std::min(m_length - 1, m_length / 3 + 1);
+
+    for (std::size_t index = 0; index != std::min<std::size_t>(m_length, 64); ++index) {
+        m_masks[static_cast<unsigned char>(name[index])] |= std::uint64_t { 1 } << index;
+    }
+    auto const all = m_length >= 64 ? ~std::uint64_t {} : (std::uint64_t { 1 } << m_length) - 1;
+    m_states.reserve(m_length + m_bound + 1);
+    m_best.reserve(m_count + 1);
+    m_states.push_back({ .positive = all, .negative = 0, .distance = m_length, .minimum = 0 });
+}
+
+auto cppargs::dtl::Name_ranking::limit() const noexcept -> std::optional<std::size_t>
+{
+    if (m_count == 0 || m_length == 0) {
+        return std::nullopt;
+    }
+    if (m_best.size() < m_count) {
+        return m_bound;
+    }
+    // Once enough names are kept, only closer ones matter.
+    auto const worst = m_best.back().distance;
+    return worst == 0 ? std::nullopt : std::optional(worst - 1);
+}
+
+auto cppargs::dtl::Name_ranking::step(State const& state, char const character) const noexcept
+    -> State
+{
+    auto const last = std::uint64_t { 1 } << (m_length - 1);
+    auto const all  = m_length == 64 ? ~std::uint64_t {} : (last << 1) - 1;
+
+    auto const match      = m_masks[static_cast<unsigned char>(character)];
+    auto const vertical   = match | state.negative;
+    auto const horizontal = (((match & state.positive) + state.positive) ^ state.positive) | match;
+
+    auto horizontal_positive = state.negative | ~(horizontal | state.positive);
+    auto horizontal_negative = state.positive & horizontal;
+
+    State next {
+        .distance = (horizontal_positive & last) != 0 ? state.distance + 1
+                  : (horizontal_negative & last) != 0 ? state.distance - 1
+                                                      : state.distance,
+    };
+
+    // The first row of the matrix grows by one in each column.
+    horizontal_positive = (horizontal_positive << 1) | 1;
+    horizontal_negative = horizontal_negative << 1;
+
+    next.positive = (horizontal_negative | ~(vertical | horizontal_positive)) & all;
+    next.negative = horizontal_positive & vertical & all;
+
+    // The smallest value in the column. It never decreases from one column to the next.
+    auto value   = next.distance;
+    next.minimum = value;
+    for (auto index = m_length; index != 0; --index) {
+        auto const bit = std::uint64_t { 1 } << (index - 1);
+        value          = value - ((next.positive & bit) != 0) + ((next.negative & bit) != 0);
+        next.minimum   = std::min(next.minimum, value);
+    }
+    return next;
+}
+
+auto cppargs::dtl::Name_ranking::add(std::string_view const candidate)
+    -> std::optional<std::size_t>
+{
+    auto const limit = this->limit();
+    if (!limit.has_value()) {
+        return 0;
+    }
+    if (candidate.size() + limit.value() < m_length) {
+        return std::nullopt; // Too short, but longer names with the same prefix may not be.
+    }
+
+    auto const shared = static_cast<std::size_t>(
+        std::ranges::mismatch(candidate, m_previous).in1 - candidate.begin());
+    m_states.resize(shared + 1);
+
+    for (auto depth = shared;; ++depth) {
+        m_previous = candidate.substr(0, depth);
+        if (m_states.back().minimum > limit.value()) {
+            return depth;
+        }
+        if (depth == candidate.size()) {
+            break;
+        }
+        if (depth == m_length + limit.value()) {
+            return depth + 1; // Longer names are too far.
+        }
+        m_states.push_back(step(m_states.back(), candidate[depth]));
+    }
+
+    auto const distance = m_states.back().distance;
+    if (distance <= limit.value()) {
+        // Among names at the same distance, the ones added first come first.
+        auto const position = std::ranges::upper_bound(m_best, distance, {}, &Candidate::distance);
+        m_best.insert(position, { .name = candidate, .distance = distance });
+        if (m_best.size() > m_count) {
+            m_best.pop_back();
+        }
+    }
+    return std::nullopt;
+}
+
+auto cppargs::dtl::Name_ranking::names() const -> std::vector<std::string_view>
+{
+    std::vector<std::string_view> names;
+    names.reserve(m_best.size());
+    for (auto const& candidate : m_best) {
+        names.push_back(candidate.name);
+    }
+    return names;
+}
+
+cppargs::dtl::Sorted_names::Sorted_names(std::pmr::memory_resource* const resource)
+    : m_names(resource)
+{}
+
+auto cppargs::dtl::Sorted_names::resource() const noexcept -> std::pmr::memory_resource*
+{
+    return m_names.get_allocator().resource();
+}
+
+auto cppargs::dtl::Sorted_names::reset() -> void
+{
+    m_built = false;
+    m_names.clear();
+}
+
+auto cppargs::dtl::Sorted_names::get(std::span<Parameter_info const> const infos)
+    -> std::span<std::string_view const>
+{
+    if (!m_built.load(std::memory_order_acquire)) {
+        std::lock_guard const lock(m_mutex);
+        if (!m_built.load(std::memory_order_relaxed)) {
+            m_names.clear();
+            m_names.reserve(infos.size());
+            for (auto const& info : infos) {
+                m_names.push_back(info.long_name);
+            }
+            std::ranges::sort(m_names);
+            m_names.erase(std::ranges::unique(m_names).begin(), m_names.end());
+            m_built.store(true, std::memory_order_release);
+        }
+    }
+    return m_names;
+}
+
+cppargs::dtl::Sorted_names_ptr::Sorted_names_ptr(std::pmr::memory_resource* const resource)
+    : m_names(std::pmr::polymorphic_allocator<>(resource).new_object<Sorted_names>(resource))
+{}
+
+cppargs::dtl::Sorted_names_ptr::Sorted_names_ptr(Sorted_names_ptr const& other)
+    : Sorted_names_ptr(other.m_names->resource())
+{}
+
+auto cppargs::dtl::Sorted_names_ptr::operator=(Sorted_names_ptr const&) -> Sorted_names_ptr&
+{
+    m_names->reset();
+    return *this;
+}
+
+cppargs::dtl::Sorted_names_ptr::~Sorted_names_ptr()
+{
+    std::pmr::polymorphic_allocator<>(m_names->resource()).delete_object(m_names);
+}
+
+auto cppargs::dtl::Sorted_names_ptr::operator->() const noexcept -> Sorted_names*
+{
+    return m_names;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+// Used by the library only. Programs get suggestions through `Parameters::suggest`.
+
+#include <cppargs.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace cppargs::dtl {
+
+    // Keeps the `count` names closest to `name` in edit distance, within a bound that grows with
+    // the length of `name`. Distances are computed 64 characters at a time. A name that shares a
+    // prefix with the previously added one resumes from the state after that prefix, so adding
+    // names in sorted order shares the work on common prefixes, and lets the caller skip every
+    // name that starts with a prefix already too far from `name`.
+    class Name_ranking {
+        struct State {
+            std::uint64_t positive {}; // Vertical deltas of +1
+            std::uint64_t negative {}; // Vertical deltas of -1
+            std::size_t   distance {};
+            std::size_t   minimum {}; // Lower bound for every name with this prefix
+        };
+
+        struct Candidate {
+            std::string_view name;
+            std::size_t      distance {};
+        };
+
+        std::array<std::uint64_t, 256> m_masks {}; // Positions of each character in `name`
+        std::vector<State>             m_states; // After each prefix of `m_previous`
+        std::string_view               m_previous;
+        std::vector<Candidate>         m_best;
+        std::size_t                    m_length {};
+        std::size_t                    m_bound {};
+        std::size_t                    m_count {};
+
+        [[nodiscard]] auto limit() const noexcept -> std::optional<std::size_t>;
+        [[nodiscard]] auto step(State const& state, char character) const noexcept -> State;
+    public:
+        Name_ranking(std::string_view name, std::size_t count);
+
+        // Returns the length of a prefix of `candidate` such that no name starting with it can
+        // be ranked any more, if there is one. With a length of zero, no name can be.
+        [[nodiscard]] auto add(std::string_view candidate) -> std::optional<std::size_t>;
+
+        [[nodiscard]] auto names() const -> std::vector<std::string_view>;
+    };
+
+    // Long names in sorted order, built on first use so that parameters that are never abbreviated
+    // or misspelled do not pay for it. The first use may come from several threads at once.
+    class Sorted_names {
+        std::mutex                         m_mutex;
+        std::atomic<bool>                  m_built;
+        std::pmr::vector<std::string_view> m_names;
+    public:
+        explicit Sorted_names(std::pmr::memory_resource* resource);
+
+        [[nodiscard]] auto resource() const noexcept -> std::pmr::memory_resource*;
+
+        auto reset() -> void;
+
+        [[nodiscard]] auto get(std::span<Parameter_info const> infos)
+            -> std::span<std::string_view const>;
+    };
+
+} // namespace cppargs::dtl
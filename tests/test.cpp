@@ -1,11 +1,62 @@
 #include <cppargs.hpp>
+#include <static_parameters.hpp>
+#include <enum_argument.hpp>
+#include <bounded_queue.hpp>
+#include <observer.hpp>
+#include <cache.hpp>
+#include <diagnostics.hpp>
+#include <completion.hpp>
+#include <schema.hpp>
+#include <parser.hpp>
+#include <subcommands.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <fstream>
+#include <format>
+#include <cstdlib>
 
 #define REQUIRE_UNREACHABLE REQUIRE(false)
 #define TEST(name)          TEST_CASE("cppargs: " name, "[cppargs]")
 
 using namespace std::literals;
 
+namespace {
+    class Counting_resource : public std::pmr::memory_resource {
+        auto do_allocate(std::size_t const bytes, std::size_t const alignment) -> void* override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        auto do_deallocate(
+            void* const pointer, std::size_t const bytes, std::size_t const alignment)
+            -> void override
+        {
+            ++deallocations;
+            std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+        }
+
+        auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override
+        {
+            return this == &other;
+        }
+    public:
+        std::size_t allocations {};
+        std::size_t deallocations {};
+    };
+
+    // Writes `contents` to a file in the temporary directory and returns its path
+    auto write_temporary_file(std::string_view const name, std::string_view const contents)
+        -> std::string
+    {
+        auto const path = std::filesystem::temp_directory_path() / name;
+        std::ofstream(path, std::ios::binary) << contents;
+        return path.string();
+    }
+} // namespace
+
 TEST("help string generation")
 {
     SECTION("non-empty")
@@ -26,6 +77,48 @@ TEST("help string generation")
     {
         REQUIRE(cppargs::Parameters().help_string().empty());
     }
+    SECTION("streaming")
+    {
+        cppargs::Parameters parameters;
+        (void)parameters.add("help", "Show this help text");
+        (void)parameters.add<int>("do-thing");
+        (void)parameters.add<std::string>('i', "interesting", "Do interesting things");
+
+        std::string string;
+        parameters.help_to(std::back_inserter(string));
+        REQUIRE(string == parameters.help_string());
+
+        char       buffer[256] {};
+        auto const end = parameters.help_to(buffer);
+        REQUIRE(std::string_view(buffer, end) == string);
+
+        auto const file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        parameters.help_to(file);
+        std::rewind(file);
+        REQUIRE(std::fread(buffer, 1, sizeof buffer, file) == string.size());
+        std::fclose(file);
+        REQUIRE(std::string_view(buffer, string.size()) == string);
+    }
+    SECTION("wrapping")
+    {
+        cppargs::Parameters parameters;
+        (void)parameters.add("help", "Show this  help text");
+        (void)parameters.add<std::string>('i', "interesting", "Do interesting things");
+
+        std::string string;
+        parameters.help_to(std::back_inserter(string), 48);
+        REQUIRE(
+            string
+            == "\t--help                  : Show this\n"
+               "\t                          help text\n"
+               "\t--interesting, -i [str] : Do interesting\n"
+               "\t                          things\n");
+
+        string.clear();
+        parameters.help_to(std::back_inserter(string), 20);
+        REQUIRE(string == parameters.help_string());
+    }
 }
 
 TEST("parse valid simple flag")
@@ -234,7 +327,103 @@ TEST("parse positional argument")
         REQUIRE(exception.info().command_line == "cppargstest hello");
         REQUIRE(exception.info().error_column == 13);
         REQUIRE(exception.info().error_width == 5);
-        REQUIRE(exception.what() == "Positional arguments are not supported yet: 'hello'"sv);
+        REQUIRE(exception.what() == "Unexpected positional argument: 'hello'"sv);
+    }
+}
+
+TEST("positional parameters")
+{
+    using Paths = cppargs::Incremental<std::string_view>;
+    using Kind  = cppargs::Parse_error_info::Kind;
+
+    constexpr auto optional = cppargs::Presence::optional;
+
+    cppargs::Parameters parameters;
+    auto const          flag    = parameters.add('f', "flag");
+    auto const          input   = parameters.add_positional<std::string_view>("input", "Input");
+    auto const          count   = parameters.add_positional<int>("count", {}, optional);
+    auto const          paths   = parameters.add_positional<Paths>("paths", {}, optional);
+    auto const          command = parameters.add_trailing("command", "Command to run");
+
+    REQUIRE_THROWS_AS(parameters.add_positional<int>("extra"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parameters.add_trailing("again"), std::invalid_argument);
+
+    SECTION("values")
+    {
+        char const* const command_line[] {
+            "cppargstest", "in", "-f", "3", "a", "-", "b", "--", "run", "--flag", "x",
+        };
+        cppargs::parse(command_line, parameters);
+        REQUIRE(flag);
+        REQUIRE(input.value() == "in");
+        REQUIRE(input.value().data() == command_line[1]);
+        REQUIRE(count.value() == 3);
+        REQUIRE(
+            std::ranges::equal(paths.values(), std::vector<std::string_view> { "a", "-", "b" }));
+        REQUIRE(command.arguments().data() == command_line + 8);
+        REQUIRE(command.arguments().size() == 3);
+    }
+    SECTION("optional")
+    {
+        char const* const command_line[] { "cppargstest", "in", "--" };
+        cppargs::parse(command_line, parameters);
+        REQUIRE(input.value() == "in");
+        REQUIRE_FALSE(count.has_value());
+        REQUIRE_FALSE(paths);
+        REQUIRE_FALSE(command);
+    }
+    SECTION("errors")
+    {
+        char const* const missing[] { "cppargstest", "-f" };
+        auto const        error = cppargs::try_parse(missing, parameters);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == Kind::missing_positional_argument);
+        REQUIRE(error->column() == 15);
+        REQUIRE(error->message() == "Missing positional argument");
+
+        char const* const invalid[] { "cppargstest", "in", "three" };
+        REQUIRE(cppargs::try_parse(invalid, parameters)->kind() == Kind::invalid_argument);
+    }
+    SECTION("missing with a null program name")
+    {
+        char const* const command_line[] { nullptr };
+        auto const        error = cppargs::try_parse(command_line, parameters);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == Kind::missing_positional_argument);
+        REQUIRE(error->column() == 1);
+        REQUIRE(error->command_line_string().empty());
+        REQUIRE_THROWS_AS(cppargs::parse(command_line, parameters), cppargs::Exception);
+    }
+    SECTION("command string")
+    {
+        cppargs::Command_string const string("-- -in 1 --flag 'a b'");
+        cppargs::parse(string, parameters);
+        REQUIRE_FALSE(flag);
+        REQUIRE(input.value() == "-in");
+        REQUIRE(std::ranges::equal(
+            paths.values(), std::vector<std::string_view> { "--flag", "a b" }));
+        REQUIRE_FALSE(command);
+    }
+    SECTION("incremental parser")
+    {
+        cppargs::Parser parser(parameters);
+        parser.feed("-f");
+        REQUIRE_THROWS_AS(parser.finish(), cppargs::Exception);
+        for (auto const argument : { "in", "--", "-1" }) {
+            parser.feed(argument);
+        }
+        parser.finish();
+        REQUIRE(count.value() == -1);
+    }
+    SECTION("help")
+    {
+        REQUIRE(
+            parameters.help_string()
+            == "\t--flag, -f      : ...\n"
+               "\t<input>         : Input\n"
+               "\t[count]         : ...\n"
+               "\t[paths]...      : ...\n"
+               "\t-- [command]... : Command to run\n");
     }
 }
 
@@ -252,3 +441,1494 @@ TEST("incremental argument")
     REQUIRE(ints.values()[2] == 35);
     REQUIRE(ints.values()[3] == 40);
 }
+
+TEST("sink parameters")
+{
+    cppargs::Parameters parameters;
+    std::vector<int>    consumed;
+    auto const          sink
+        = parameters.add_sink<int>('i', "int", "Consumed", [&](int const value) {
+              consumed.push_back(value);
+          });
+
+    SECTION("values are passed on as they are parsed")
+    {
+        char const* const command_line[] { "cppargstest", "-i1", "--int", "2", "-x", "-i3" };
+        REQUIRE_THROWS_AS(cppargs::parse(command_line, parameters), cppargs::Exception);
+        REQUIRE(consumed == std::vector { 1, 2 });
+        REQUIRE(sink.count() == 2);
+        REQUIRE_FALSE(cppargs::Parse_cache::is_eligible(parameters));
+        REQUIRE(parameters.help_string() == "\t--int, -i [int] : Consumed\n");
+    }
+    SECTION("parallel parse keeps the order")
+    {
+        std::vector<std::string> arguments { "cppargstest" };
+        for (int index = 0; index != 1000; ++index) {
+            arguments.push_back("-i" + std::to_string(index));
+        }
+        std::vector<char const*> pointers;
+        for (auto const& argument : arguments) {
+            pointers.push_back(argument.c_str());
+        }
+        cppargs::parse_parallel(pointers, parameters, 4);
+        REQUIRE(consumed.size() == 1000);
+        REQUIRE(std::ranges::is_sorted(consumed));
+        REQUIRE(sink.count() == 1000);
+    }
+    SECTION("bounded queue")
+    {
+        cppargs::Parameters         queued;
+        cppargs::Bounded_queue<int> queue(2);
+        auto const                  ints = queued.add_sink<int>(
+            "int", "Queued", [&](int const value) { REQUIRE(queue.push(value)); });
+        std::vector<int> popped;
+        std::jthread     consumer([&] {
+            while (auto const value = queue.pop()) {
+                popped.push_back(*value);
+            }
+        });
+
+        std::vector<std::string> arguments { "cppargstest" };
+        for (int index = 0; index != 100; ++index) {
+            arguments.insert(arguments.end(), { "--int", std::to_string(index) });
+        }
+        std::vector<char const*> pointers;
+        for (auto const& argument : arguments) {
+            pointers.push_back(argument.c_str());
+        }
+        cppargs::parse(pointers, queued);
+        queue.close();
+        consumer.join();
+        REQUIRE(popped.size() == 100);
+        REQUIRE(std::ranges::is_sorted(popped));
+        REQUIRE(ints.count() == 100);
+        REQUIRE_FALSE(queue.push(100));
+    }
+}
+
+TEST("parameter lookup")
+{
+    cppargs::Parameters parameters;
+    (void)parameters.add('a', "aaa");
+    (void)parameters.add<int>('b', "bbb");
+    (void)parameters.add<int>('a', "aaa", "Duplicate");
+    (void)parameters.add("ccc");
+
+    REQUIRE(parameters.find("aaa") == &parameters.info_span()[0]);
+    REQUIRE(parameters.find("bbb") == &parameters.info_span()[1]);
+    REQUIRE(parameters.find("ccc") == &parameters.info_span()[3]);
+    REQUIRE(parameters.find("ddd") == nullptr);
+    REQUIRE(parameters.find('a') == &parameters.info_span()[0]);
+    REQUIRE(parameters.find('b') == &parameters.info_span()[1]);
+    REQUIRE(parameters.find('c') == nullptr);
+    REQUIRE(parameters.find('\xff') == nullptr);
+
+    SECTION("help metadata")
+    {
+        REQUIRE(parameters.help_span().size() == parameters.info_span().size());
+        REQUIRE(parameters.help_of(*parameters.find("bbb")).type_name == "int");
+        REQUIRE(parameters.help_span()[2].description == "Duplicate");
+        REQUIRE(parameters.help_of(*parameters.find('a')).description.empty());
+    }
+}
+
+TEST("parse with many parameters")
+{
+    cppargs::Parameters      parameters;
+    std::vector<std::string> names;
+    for (int i = 0; i != 500; ++i) {
+        names.push_back(std::format("option-{}", i));
+    }
+    std::vector<cppargs::Parameter<int>> options;
+    for (auto const& name : names) {
+        options.push_back(parameters.add<int>(name));
+    }
+    char const* const command_line[] { "cppargstest", "--option-499", "5", "--option-0", "7" };
+    cppargs::parse(command_line, parameters);
+    REQUIRE(options.front().value() == 7);
+    REQUIRE(options.back().value() == 5);
+    REQUIRE_FALSE(options[250].has_value());
+}
+
+TEST("static parameters")
+{
+    using Parameters = cppargs::Static_parameters<
+        cppargs::option('h', "help", "Show this help text"),
+        cppargs::option<int>('s', "square"),
+        cppargs::option<std::string_view>("name"),
+        cppargs::option<cppargs::Incremental<int>>('i', "int")>;
+
+    SECTION("valid")
+    {
+        Parameters        parameters;
+        char const* const command_line[] {
+            "cppargstest", "--square", "5", "-hi10", "--name", "hello", "-i", "20",
+        };
+        cppargs::parse(command_line, parameters);
+        REQUIRE(parameters.get<"help">().has_value());
+        REQUIRE(parameters.get<"square">().value() == 5);
+        REQUIRE(parameters.get<"name">().value() == "hello");
+        REQUIRE(parameters.get<"int">().values().size() == 2);
+        REQUIRE(parameters.get<"int">().values()[0] == 10);
+        REQUIRE(parameters.get<"int">().values()[1] == 20);
+    }
+    SECTION("empty")
+    {
+        Parameters        parameters;
+        char const* const command_line[] { "cppargstest" };
+        cppargs::parse(command_line, parameters);
+        REQUIRE_FALSE(parameters.get<"help">());
+        REQUIRE_FALSE(parameters.get<"square">());
+        REQUIRE_FALSE(parameters.get<"int">());
+    }
+    SECTION("invalid")
+    {
+        Parameters        parameters;
+        char const* const command_line[] { "cppargstest", "-hx" };
+        try {
+            cppargs::parse(command_line, parameters);
+            REQUIRE_UNREACHABLE;
+        }
+        catch (cppargs::Exception const& exception) {
+            REQUIRE(exception.info().kind == cppargs::Parse_error_info::Kind::unrecognized_option);
+            REQUIRE(exception.info().command_line == "cppargstest -hx");
+            REQUIRE(exception.info().error_column == 15);
+            REQUIRE(exception.what() == "Unrecognized option: 'x'"sv);
+        }
+    }
+}
+
+TEST("memory resource")
+{
+    SECTION("values are allocated from the resource")
+    {
+        Counting_resource resource;
+        {
+            cppargs::Parameters parameters(&resource);
+            auto const          a = parameters.add<int>('a', "aaa");
+            auto const          b = parameters.add<std::pmr::string>('b', "bbb");
+            auto const          c = parameters.add<cppargs::Incremental<std::pmr::string>>("ccc");
+            REQUIRE(parameters.resource() == &resource);
+
+            auto const before = resource.allocations;
+            char const* const command_line[] {
+                "cppargstest", "-a5", "-b", "a string too long for the small string buffer",
+                "--ccc", "another string too long for the small string buffer",
+            };
+            cppargs::parse(command_line, parameters);
+            REQUIRE(resource.allocations > before);
+            REQUIRE(a.value() == 5);
+            REQUIRE(b.value().get_allocator().resource() == &resource);
+            REQUIRE(c.values().front().get_allocator().resource() == &resource);
+        }
+        REQUIRE(resource.allocations == resource.deallocations);
+    }
+    SECTION("monotonic arena")
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        cppargs::Parameters                 parameters(&arena);
+        auto const ints = parameters.add<cppargs::Incremental<int>>('i', "int");
+        auto const flag = parameters.add('f', "flag");
+        char const* const command_line[] { "cppargstest", "-i1", "-fi2", "--int", "3" };
+        cppargs::parse(command_line, parameters);
+        REQUIRE(flag.has_value());
+        REQUIRE(ints.values().size() == 3);
+        REQUIRE(ints.values()[2] == 3);
+    }
+}
+
+TEST("try parse")
+{
+    cppargs::Parameters parameters;
+    auto const          a = parameters.add<int>('a', "aaa");
+    SECTION("valid")
+    {
+        char const* const command_line[] { "cppargstest", "--aaa", "5" };
+        REQUIRE_FALSE(cppargs::try_parse(command_line, parameters).has_value());
+        REQUIRE(a.value() == 5);
+    }
+    SECTION("invalid")
+    {
+        char const* const command_line[] { "cppargstest", "-a", "5", "-ahello" };
+        auto const        error = cppargs::try_parse(command_line, parameters);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == cppargs::Parse_error_info::Kind::invalid_argument);
+        REQUIRE(error->view() == "hello");
+        REQUIRE(error->argument_index() == 3);
+        REQUIRE(error->column() == 20);
+        REQUIRE(error->command_line_string() == "cppargstest -a 5 -ahello");
+        REQUIRE(error->message() == "Invalid argument: 'hello'");
+        REQUIRE(cppargs::Exception(error.value()).info().error_column == 20);
+    }
+}
+
+TEST("response files")
+{
+    cppargs::Parameters parameters;
+    auto const          ints = parameters.add<cppargs::Incremental<int>>('i', "int");
+    auto const          name = parameters.add<std::string_view>('n', "name");
+    auto const          flag = parameters.add('f', "flag");
+
+    auto const inner = write_temporary_file("cppargs-test-inner.rsp", "--int 3\n-fi 4");
+    auto const outer = write_temporary_file(
+        "cppargs-test-outer.rsp", std::format("-i1\n  --name hello\t@{} --int\n", inner));
+
+    SECTION("expansion")
+    {
+        cppargs::Response_files files;
+        auto const              argument = "@" + outer;
+        char const* const       command_line[] { "cppargstest", argument.c_str(), "5" };
+        cppargs::parse(command_line, parameters, files);
+        REQUIRE(flag.has_value());
+        REQUIRE(ints.values().size() == 4);
+        REQUIRE(ints.values()[0] == 1);
+        REQUIRE(ints.values()[1] == 3);
+        REQUIRE(ints.values()[2] == 4);
+        REQUIRE(ints.values()[3] == 5);
+
+        auto const text = files.open(outer)->text;
+        REQUIRE(name.value() == "hello");
+        REQUIRE(name.value().data() > text.data());
+        REQUIRE(name.value().data() < text.data() + text.size());
+    }
+    SECTION("disabled")
+    {
+        auto const        argument = "@" + outer;
+        char const* const command_line[] { "cppargstest", argument.c_str() };
+        auto const        error = cppargs::try_parse(command_line, parameters);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == cppargs::Parse_error_info::Kind::positional_argument);
+    }
+    SECTION("error location")
+    {
+        auto const path = write_temporary_file("cppargs-test-error.rsp", "-i1\n  --int x2\n");
+        cppargs::Response_files files;
+        auto const              argument = "@" + path;
+        char const* const       command_line[] { "cppargstest", "-f", argument.c_str() };
+        try {
+            cppargs::parse(command_line, parameters, files);
+            REQUIRE_UNREACHABLE;
+        }
+        catch (cppargs::Exception const& exception) {
+            REQUIRE(exception.info().kind == cppargs::Parse_error_info::Kind::invalid_argument);
+            REQUIRE(exception.info().source == path);
+            REQUIRE(exception.info().command_line == "  --int x2");
+            REQUIRE(exception.info().error_line == 2);
+            REQUIRE(exception.info().error_column == 9);
+            REQUIRE(exception.info().error_width == 2);
+            REQUIRE(exception.what() == "Invalid argument: 'x2'"sv);
+        }
+    }
+    SECTION("recursion")
+    {
+        auto const path = write_temporary_file("cppargs-test-recursive.rsp", "");
+        write_temporary_file("cppargs-test-recursive.rsp", std::format("-f @{}", path));
+        cppargs::Response_files files;
+        auto const              argument = "@" + path;
+        char const* const       command_line[] { "cppargstest", argument.c_str() };
+        auto const              error = cppargs::try_parse(command_line, parameters, files);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == cppargs::Parse_error_info::Kind::recursive_response_file);
+        REQUIRE(error->file() != nullptr);
+        REQUIRE(error->column() == 5);
+        REQUIRE(error->view() == path);
+    }
+    SECTION("unreadable")
+    {
+        cppargs::Response_files files;
+        char const* const       command_line[] { "cppargstest", "-f", "@/does/not/exist" };
+        auto const              error = cppargs::try_parse(command_line, parameters, files);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == cppargs::Parse_error_info::Kind::unreadable_response_file);
+        REQUIRE(error->file() == nullptr);
+        REQUIRE(error->column() == 17);
+        REQUIRE(error->message() == "Could not read response file: '/does/not/exist'");
+    }
+}
+
+TEST("incremental parser")
+{
+    cppargs::Parameters parameters;
+    auto const          ints = parameters.add<cppargs::Incremental<int>>('i', "int");
+    auto const          flag = parameters.add('f', "flag");
+    cppargs::Parser     parser(parameters);
+
+    SECTION("valid")
+    {
+        for (std::string argument : { "-fi", "10", "--int", "20", "-i30" }) {
+            parser.feed(argument);
+            argument.assign("clobbered");
+        }
+        REQUIRE_FALSE(parser.is_pending());
+        parser.finish();
+        REQUIRE(flag.has_value());
+        REQUIRE(ints.values().size() == 3);
+        REQUIRE(ints.values()[0] == 10);
+        REQUIRE(ints.values()[1] == 20);
+        REQUIRE(ints.values()[2] == 30);
+    }
+    SECTION("missing argument")
+    {
+        parser.feed("-fi");
+        REQUIRE(parser.is_pending());
+        try {
+            parser.finish();
+            REQUIRE_UNREACHABLE;
+        }
+        catch (cppargs::Exception const& exception) {
+            REQUIRE(exception.info().kind == cppargs::Parse_error_info::Kind::missing_argument);
+            REQUIRE(exception.info().command_line == "-fi");
+            REQUIRE(exception.info().error_column == 3);
+            REQUIRE(exception.what() == "Missing argument for parameter: 'i'"sv);
+        }
+        REQUIRE_FALSE(parser.is_pending());
+    }
+    SECTION("invalid argument")
+    {
+        parser.feed("--int");
+        try {
+            parser.feed("hello");
+            REQUIRE_UNREACHABLE;
+        }
+        catch (cppargs::Exception const& exception) {
+            REQUIRE(exception.info().kind == cppargs::Parse_error_info::Kind::invalid_argument);
+            REQUIRE(exception.info().command_line == "hello");
+            REQUIRE(exception.info().error_column == 1);
+            REQUIRE(exception.info().error_width == 5);
+        }
+        parser.feed("-i5");
+        REQUIRE(ints.values().size() == 1);
+    }
+}
+
+TEST("schema and values")
+{
+    cppargs::Schema schema;
+    auto const      number = schema.add<int>('n', "number");
+    auto const      name   = schema.add<std::string>("name", "Some name");
+    auto const      ints   = schema.add<cppargs::Incremental<int>>('i', "int");
+    auto const      flag   = schema.add('f', "flag");
+
+    REQUIRE(schema.info_span().size() == 4);
+    REQUIRE(schema.find("name") == &schema.info_span()[1]);
+    REQUIRE(schema.find('i') == &schema.info_span()[2]);
+
+    SECTION("parse and reset")
+    {
+        cppargs::Values   values(schema);
+        char const* const command_line[] {
+            "cppargstest", "-n5", "--name", "hello", "-fi1", "--int", "2",
+        };
+        cppargs::parse(command_line, schema, values);
+        REQUIRE(number.value(values) == 5);
+        REQUIRE(name.value(values) == "hello");
+        REQUIRE(flag.has_value(values));
+        REQUIRE(ints.values(values).size() == 2);
+        REQUIRE(ints.values(values)[1] == 2);
+
+        values.reset();
+        REQUIRE_FALSE(number.has_value(values));
+        REQUIRE_FALSE(name.has_value(values));
+        REQUIRE_FALSE(flag.has_value(values));
+        REQUIRE(ints.values(values).empty());
+    }
+    SECTION("error")
+    {
+        cppargs::Values   values(schema);
+        char const* const command_line[] { "cppargstest", "--number", "x" };
+        auto const        error = cppargs::try_parse(command_line, schema, values);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == cppargs::Parse_error_info::Kind::invalid_argument);
+        REQUIRE_FALSE(number.has_value(values));
+    }
+    SECTION("concurrent parsing")
+    {
+        constexpr int            thread_count = 8;
+        std::vector<int>         failures(thread_count);
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread != thread_count; ++thread) {
+            threads.emplace_back([&, thread] {
+                cppargs::Values   values(schema);
+                auto const        string = std::to_string(thread);
+                auto const        value  = string.c_str();
+                char const* const command_line[] {
+                    "cppargstest", "-n", value, "--name", value, "-i", value,
+                };
+                for (int iteration = 0; iteration != 1000; ++iteration) {
+                    values.reset();
+                    cppargs::parse(command_line, schema, values);
+                    if (number.value(values) != thread || name.value(values) != string
+                        || ints.values(values).size() != 1)
+                    {
+                        ++failures[thread];
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(std::ranges::count(failures, 0) == thread_count);
+    }
+}
+
+TEST("command string")
+{
+    auto const split = [](std::string_view const string) {
+        cppargs::Command_string const command_string(string);
+        REQUIRE_FALSE(command_string.unterminated_quote().has_value());
+        auto const arguments = command_string.arguments();
+        return std::vector<std::string>(arguments.begin(), arguments.end());
+    };
+
+    SECTION("splitting")
+    {
+        using Strings = std::vector<std::string>;
+        REQUIRE(split("").empty());
+        REQUIRE(split(" \t\n").empty());
+        REQUIRE(split("a bb\tccc\n") == Strings { "a", "bb", "ccc" });
+        REQUIRE(split("'a b' \"c d\" e\\ f") == Strings { "a b", "c d", "e f" });
+        REQUIRE(split("x'y'\"z\" '' \"\"") == Strings { "xyz", "", "" });
+        REQUIRE(split(R"("\$\`\"\\\a" '\n')") == Strings { R"($`"\\a)", R"(\n)" });
+        REQUIRE(split("a \\\n b\\\nc") == Strings { "a", "bc" });
+        REQUIRE(split("trailing\\") == Strings { "trailing\\" });
+
+        // Long enough to go through the vectorized scan
+        std::string const long_argument(100, 'x');
+        REQUIRE(split(long_argument + " '" + long_argument + "'")
+                == Strings { long_argument, long_argument });
+    }
+    SECTION("zero copy")
+    {
+        std::string_view const         string = "--name value 'quoted'";
+        cppargs::Command_string const command_string(string);
+        auto const                     arguments = command_string.arguments();
+        REQUIRE(arguments.size() == 3);
+        REQUIRE(arguments[0].data() == string.data());
+        REQUIRE(arguments[1].data() == string.data() + 7);
+        REQUIRE(arguments[2] == "quoted");
+    }
+    SECTION("parse")
+    {
+        cppargs::Parameters parameters;
+        auto const          name  = parameters.add<std::string>('n', "name");
+        auto const          ints  = parameters.add<cppargs::Incremental<int>>('i', "int");
+        auto const          flags = parameters.add('f', "flag");
+
+        cppargs::Command_string const command_string("-f --name 'hello world' -i1 --int \"2\"");
+        cppargs::parse(command_string, parameters);
+        REQUIRE(flags);
+        REQUIRE(name.value() == "hello world");
+        REQUIRE(std::ranges::equal(ints.values(), std::vector { 1, 2 }));
+    }
+    SECTION("errors")
+    {
+        cppargs::Parameters parameters;
+        auto const          number = parameters.add<int>('n', "number");
+
+        cppargs::Command_string const plain("-n 1\n--bad");
+        auto const                    unrecognized = cppargs::try_parse(plain, parameters);
+        REQUIRE(unrecognized.has_value());
+        REQUIRE(unrecognized->kind() == cppargs::Parse_error_info::Kind::unrecognized_option);
+        REQUIRE(unrecognized->argument_index() == 2);
+        REQUIRE(unrecognized->line() == 2);
+        REQUIRE(unrecognized->column() == 3);
+        REQUIRE(unrecognized->command_line_string() == "--bad");
+
+        cppargs::Command_string const quoted("-n 1 --number 'x y'");
+        auto const                    invalid = cppargs::try_parse(quoted, parameters);
+        REQUIRE(invalid.has_value());
+        REQUIRE(invalid->kind() == cppargs::Parse_error_info::Kind::invalid_argument);
+        REQUIRE(invalid->column() == 15);
+        REQUIRE(invalid->info().source.empty());
+
+        cppargs::Command_string const unterminated("-n 1 \"abc");
+        REQUIRE(unterminated.unterminated_quote() == 5);
+        REQUIRE(unterminated.arguments().size() == 2);
+        auto const quote = cppargs::try_parse(unterminated, parameters);
+        REQUIRE(quote.has_value());
+        REQUIRE(quote->kind() == cppargs::Parse_error_info::Kind::unterminated_quote);
+        REQUIRE(quote->column() == 6);
+        REQUIRE_THROWS_AS(cppargs::parse(unterminated, parameters), cppargs::Exception);
+        REQUIRE(number.value() == 1);
+    }
+}
+
+TEST("list")
+{
+    cppargs::Parameters parameters;
+    auto const          ints   = parameters.add<cppargs::List<int>>('i', "ints", "Integers");
+    auto const          ids    = parameters.add<cppargs::List<std::uint64_t, ':'>>("ids");
+    auto const          shorts = parameters.add<cppargs::List<std::int8_t>>("shorts");
+    auto const          names  = parameters.add<cppargs::List<std::string>>("names");
+
+    auto const parse = [&](std::vector<char const*> arguments) {
+        arguments.insert(arguments.begin(), "cppargstest");
+        return cppargs::try_parse(arguments, parameters);
+    };
+
+    SECTION("help")
+    {
+        REQUIRE(
+            parameters.help_string()
+            == "\t--ints, -i [int,...] : Integers\n"
+               "\t--ids [int:...]      : ...\n"
+               "\t--shorts [int,...]   : ...\n"
+               "\t--names [str,...]    : ...\n");
+    }
+    SECTION("values")
+    {
+        REQUIRE_FALSE(parse({ "--ints", "1,-2,345678901,0", "-i7", "--ids", "",
+                              "--names", "a,,b c" })
+                          .has_value());
+        REQUIRE(std::ranges::equal(ints.values(), std::vector { 1, -2, 345678901, 0, 7 }));
+        REQUIRE(std::ranges::equal(names.values(), std::vector<std::string> { "a", "", "b c" }));
+        REQUIRE_FALSE(ids);
+    }
+    SECTION("long numbers")
+    {
+        REQUIRE_FALSE(parse({ "--ids",
+                              "18446744073709551615:1234567890123456789:"
+                              "00000000000000000000042:12345678" })
+                          .has_value());
+        REQUIRE(std::ranges::equal(
+            ids.values(),
+            std::vector<std::uint64_t> {
+                18446744073709551615U, 1234567890123456789U, 42, 12345678 }));
+    }
+    SECTION("many values")
+    {
+        std::string      string;
+        std::vector<int> expected;
+        for (int value = -5000; value < 5000; value += 7) {
+            string += std::to_string(value * 1000) + ",";
+            expected.push_back(value * 1000);
+        }
+        string.pop_back();
+        REQUIRE_FALSE(parse({ "--ints", string.c_str() }).has_value());
+        REQUIRE(std::ranges::equal(ints.values(), expected));
+    }
+    SECTION("invalid")
+    {
+        REQUIRE_FALSE(parse({ "--ints", "5" }).has_value());
+        for (char const* const argument : {
+                 "1,", ",1", "1,,2", "1;2", "x", "-", "+1", "2147483648", "1 ",
+                 "999999999999999999999", "000000000000000000001x" })
+        {
+            auto const error = parse({ "--ints", argument });
+            REQUIRE(error.has_value());
+            REQUIRE(error->kind() == cppargs::Parse_error_info::Kind::invalid_argument);
+            // Elements of the failing argument are not kept
+            REQUIRE(std::ranges::equal(ints.values(), std::vector { 5 }));
+        }
+        REQUIRE(parse({ "--shorts", "127,128" }).has_value());
+        REQUIRE(parse({ "--shorts", "-128,-129" }).has_value());
+        REQUIRE(parse({ "--ids", "-1" }).has_value());
+        REQUIRE(parse({ "--ids", "18446744073709551616" }).has_value());
+    }
+}
+
+TEST("parallel parse")
+{
+    struct Handles {
+        cppargs::Parameters parameters;
+
+        cppargs::Parameter<int>                       number = parameters.add<int>('n', "n");
+        cppargs::Parameter<cppargs::Incremental<int>> ints
+            = parameters.add<cppargs::Incremental<int>>('i', "i");
+        cppargs::Parameter<cppargs::List<int>> list = parameters.add<cppargs::List<int>>("list");
+        cppargs::Parameter<std::string>        name = parameters.add<std::string>("name");
+        cppargs::Parameter<cppargs::Unit>      flag = parameters.add('f', "flag");
+    };
+
+    std::vector<std::string> arguments { "cppargstest" };
+    for (int index = 0; index != 3000; ++index) {
+        auto const value = std::to_string(index);
+        switch (index % 5) {
+        case 0:
+            arguments.insert(arguments.end(), { "-n", value });
+            break;
+        case 1:
+            arguments.push_back("-fi" + value);
+            break;
+        case 2:
+            arguments.insert(arguments.end(), { "--list", value + "," + value });
+            break;
+        case 3:
+            arguments.insert(arguments.end(), { "--name", "name" + value });
+            break;
+        default:
+            arguments.insert(arguments.end(), { "--i", value });
+        }
+    }
+
+    auto const pointers = [](std::vector<std::string> const& strings) {
+        std::vector<char const*> vector;
+        for (auto const& string : strings) {
+            vector.push_back(string.c_str());
+        }
+        return vector;
+    };
+
+    auto const same_values = [](Handles const& a, Handles const& b) {
+        return a.number.has_value() == b.number.has_value()
+            && (!a.number || a.number.value() == b.number.value())
+            && std::ranges::equal(a.ints.values(), b.ints.values())
+            && std::ranges::equal(a.list.values(), b.list.values())
+            && a.name.has_value() == b.name.has_value()
+            && (!a.name || a.name.value() == b.name.value())
+            && a.flag.has_value() == b.flag.has_value();
+    };
+
+    SECTION("same values as a serial parse")
+    {
+        auto const command_line = pointers(arguments);
+        Handles    serial;
+        cppargs::parse(command_line, serial.parameters);
+
+        for (std::size_t const thread_count : { 0, 1, 3, 8 }) {
+            Handles parallel;
+            cppargs::parse_parallel(command_line, parallel.parameters, thread_count);
+            REQUIRE(same_values(serial, parallel));
+        }
+        REQUIRE(serial.ints.values().size() == 1200);
+        REQUIRE(serial.number.value() == 2995);
+    }
+    SECTION("first error by position")
+    {
+        auto with_errors        = arguments;
+        with_errors[4001]       = "--bad";
+        with_errors[1001]       = "x";
+        with_errors[3001]       = "-ix";
+        auto const command_line = pointers(with_errors);
+
+        Handles    serial;
+        auto const expected = cppargs::try_parse(command_line, serial.parameters);
+        REQUIRE(expected.has_value());
+        REQUIRE(expected->argument_index() == 1001);
+
+        for (std::size_t const thread_count : { 1, 4, 16 }) {
+            Handles    parallel;
+            auto const error
+                = cppargs::try_parse_parallel(command_line, parallel.parameters, thread_count);
+            REQUIRE(error.has_value());
+            REQUIRE(error->kind() == cppargs::Parse_error_info::Kind::invalid_argument);
+            REQUIRE(error->argument_index() == 1001);
+            REQUIRE(error->message() == expected->message());
+            REQUIRE(same_values(serial, parallel));
+        }
+
+        with_errors[501] = "--bad";
+        Handles    handles;
+        auto const scan_error
+            = cppargs::try_parse_parallel(pointers(with_errors), handles.parameters, 4);
+        REQUIRE(scan_error.has_value());
+        REQUIRE(scan_error->kind() == cppargs::Parse_error_info::Kind::unrecognized_option);
+        REQUIRE(scan_error->argument_index() == 501);
+    }
+}
+
+TEST("environment")
+{
+    cppargs::Parameters parameters;
+    auto const          size    = parameters.add<int>('s', "max-size");
+    auto const          name    = parameters.add<std::string>("name");
+    auto const          verbose = parameters.add('v', "verbose");
+    auto const          ids     = parameters.add<cppargs::List<int>>("ids");
+    auto const          other   = parameters.add<int>("other");
+
+    parameters.set_environment_prefix("APP_");
+    parameters.set_environment_variable("other", "OTHER_VALUE");
+    REQUIRE_THROWS_AS(parameters.set_environment_variable("missing", "X"), std::invalid_argument);
+
+    REQUIRE(parameters.find_environment("APP_MAX_SIZE") == parameters.find("max-size"));
+    REQUIRE(parameters.find_environment("OTHER_VALUE") == parameters.find("other"));
+    REQUIRE(parameters.find_environment("APP_") == nullptr);
+    REQUIRE(parameters.find_environment("MAX_SIZE") == nullptr);
+    REQUIRE(parameters.find_environment("APP_MISSING") == nullptr);
+
+    SECTION("long names that the prefix does not reach")
+    {
+        std::string const long_name(200, 'x');
+        (void)parameters.add<int>(long_name);
+        (void)parameters.add<int>("snake_case");
+        (void)parameters.add<int>("Upper");
+        REQUIRE(parameters.find_environment("APP_" + std::string(200, 'X')) != nullptr);
+        REQUIRE(parameters.find_environment("APP_SNAKE_CASE") == nullptr);
+        REQUIRE(parameters.find_environment("APP_UPPER") == nullptr);
+
+        parameters.set_environment_variable("snake_case", "APP_SNAKE_CASE");
+        REQUIRE(parameters.find_environment("APP_SNAKE_CASE") == parameters.find("snake_case"));
+    }
+    SECTION("values")
+    {
+        char const* const environment[] {
+            "HOME=/root",  "APP_MAX_SIZE=10", "APP_NAME=env", "APP_VERBOSE=yes",
+            "APP_IDS=1,2", "OTHER_VALUE=3",   "NO_EQUALS",
+        };
+        char const* const command_line[] { "cppargstest", "--name", "command line" };
+        cppargs::parse(command_line, parameters);
+        cppargs::parse_environment(environment, parameters);
+
+        REQUIRE(size.value() == 10);
+        REQUIRE(name.value() == "command line");
+        REQUIRE(verbose);
+        REQUIRE(std::ranges::equal(ids.values(), std::vector { 1, 2 }));
+        REQUIRE(other.value() == 3);
+    }
+    SECTION("disabled flag")
+    {
+        char const* const environment[] { "APP_VERBOSE=0" };
+        REQUIRE_FALSE(cppargs::try_parse_environment(environment, parameters).has_value());
+        REQUIRE_FALSE(verbose);
+    }
+    SECTION("error")
+    {
+        char const* const environment[] { "APP_NAME=x", "APP_MAX_SIZE=big" };
+        auto const        error = cppargs::try_parse_environment(environment, parameters);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == cppargs::Parse_error_info::Kind::invalid_argument);
+        REQUIRE(error->command_line_string() == "APP_MAX_SIZE=big");
+        REQUIRE(error->column() == 14);
+        REQUIRE(error->view() == "big");
+    }
+#if !defined(_WIN32)
+    SECTION("process environment")
+    {
+        REQUIRE(::setenv("APP_MAX_SIZE", "42", 1) == 0);
+        char const* const command_line[] { "cppargstest" };
+        cppargs::parse(command_line, parameters);
+        REQUIRE(::unsetenv("APP_MAX_SIZE") == 0);
+        REQUIRE(size.value() == 42);
+    }
+#endif
+}
+
+TEST("config files")
+{
+    cppargs::Parameters parameters;
+    auto const          size    = parameters.add<int>("cache-size");
+    auto const          name    = parameters.add<std::string_view>("name");
+    auto const          verbose = parameters.add("verbose");
+    auto const          ints    = parameters.add<cppargs::Incremental<int>>("int");
+    auto const          level   = parameters.add<int>("level");
+
+    auto const path = write_temporary_file(
+        "cppargs-test.conf",
+        "# comment\n"
+        "name = \" config \"\r\n"
+        "verbose\n"
+        "int=1\n"
+        "int = 2\n"
+        "\n"
+        "[cache]\n"
+        "  ; comment\n"
+        "  size = 64\n"
+        "[]\n"
+        "level = 3\n");
+    cppargs::Response_files files;
+    auto const              file = files.open(path);
+    REQUIRE(file != nullptr);
+
+    SECTION("values")
+    {
+        cppargs::parse_config(*file, parameters);
+        REQUIRE(size.value() == 64);
+        REQUIRE(name.value() == " config ");
+        REQUIRE(name.value().data() > file->text.data());
+        REQUIRE(name.value().data() < file->text.data() + file->text.size());
+        REQUIRE(verbose);
+        REQUIRE(std::ranges::equal(ints.values(), std::vector { 1, 2 }));
+        REQUIRE(level.value() == 3);
+    }
+    SECTION("layering")
+    {
+        char const* const command_line[] { "cppargstest", "--int", "5", "--level", "4" };
+        cppargs::parse(command_line, parameters);
+        auto const other
+            = write_temporary_file("cppargs-test-other.conf", "level = 7\ncache-size = 1\n");
+        cppargs::parse_config(*file, parameters);
+        cppargs::parse_config(*files.open(other), parameters);
+        REQUIRE(std::ranges::equal(ints.values(), std::vector { 5 }));
+        REQUIRE(level.value() == 4);
+        REQUIRE(size.value() == 64);
+    }
+    SECTION("errors")
+    {
+        using Kind = cppargs::Parse_error_info::Kind;
+
+        auto const error = [&](std::string_view const contents) {
+            auto const path = write_temporary_file("cppargs-test-error.conf", contents);
+            cppargs::Response_files files;
+            try {
+                cppargs::parse_config(*files.open(path), parameters);
+            }
+            catch (cppargs::Exception const& exception) {
+                REQUIRE(exception.info().source == path);
+                return exception.info();
+            }
+            FAIL("no error");
+            return cppargs::Parse_error_info {};
+        };
+
+        auto const invalid = error("name = x\n\n  level = high\n");
+        REQUIRE(invalid.kind == Kind::invalid_argument);
+        REQUIRE(invalid.command_line == "  level = high");
+        REQUIRE(invalid.error_line == 3);
+        REQUIRE(invalid.error_column == 11);
+        REQUIRE(invalid.error_width == 4);
+
+        auto const unknown = error("[cache]\nlevel = 1\n");
+        REQUIRE(unknown.kind == Kind::unrecognized_option);
+        REQUIRE(unknown.error_line == 2);
+        REQUIRE(unknown.error_column == 1);
+
+        REQUIRE(error("level\n").kind == Kind::missing_argument);
+        REQUIRE(error("verbose = maybe\n").kind == Kind::invalid_argument);
+        REQUIRE(error("[cache\n").kind == Kind::malformed_line);
+        REQUIRE(error(" = 1\n").kind == Kind::malformed_line);
+    }
+}
+
+TEST("subcommands")
+{
+    using Kind = cppargs::Parse_error_info::Kind;
+
+    cppargs::Parameters global;
+    auto const          verbose = global.add('v', "verbose");
+
+    std::size_t                          builds {};
+    cppargs::Parameter<int>              jobs;
+    cppargs::Parameter<cppargs::Unit>    force;
+    cppargs::Parameter<std::string_view> target;
+    cppargs::Subcommands                 subcommands;
+
+    subcommands.add("build", "Build a target", [&](cppargs::Parameters& parameters) {
+        ++builds;
+        jobs   = parameters.add<int>('j', "jobs", "Number of jobs");
+        target = parameters.add_positional<std::string_view>("target");
+    });
+    subcommands.add("clean", {}, [&](cppargs::Parameters& parameters) {
+        ++builds;
+        force = parameters.add('f', "force");
+    });
+    REQUIRE_THROWS_AS(subcommands.add("build", {}, {}), std::invalid_argument);
+
+    SECTION("dispatch")
+    {
+        char const* const command_line[] { "cppargstest", "-v", "build", "-j4", "all" };
+        subcommands.parse(command_line, global);
+        REQUIRE(builds == 1);
+        REQUIRE(subcommands.selected() == "build");
+        REQUIRE(verbose);
+        REQUIRE(jobs.value() == 4);
+        REQUIRE(target.value() == "all");
+        REQUIRE(subcommands.parameters()->find("jobs") != nullptr);
+        REQUIRE(subcommands.parameters()->find("force") == nullptr);
+        REQUIRE(subcommands.help_string("build") == subcommands.parameters()->help_string());
+        REQUIRE(builds == 1);
+
+        // Only the handles of the other subcommand are rebound
+        REQUIRE(subcommands.help_string("clean") == "\t--force, -f : ...\n");
+        REQUIRE(builds == 2);
+        REQUIRE(jobs.value() == 4);
+        REQUIRE_FALSE(force);
+    }
+    SECTION("help")
+    {
+        REQUIRE(subcommands.parameters() == nullptr);
+        REQUIRE(
+            subcommands.help_string()
+            == "\tbuild : Build a target\n"
+               "\tclean : ...\n");
+        REQUIRE(subcommands.help_string("clean") == "\t--force, -f : ...\n");
+        REQUIRE(builds == 1);
+        REQUIRE_THROWS_AS((void)subcommands.help_string("other"), std::invalid_argument);
+    }
+    SECTION("errors")
+    {
+        char const* const missing[] { "cppargstest", "-v" };
+        auto              error = subcommands.try_parse(missing, global);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == Kind::missing_subcommand);
+        REQUIRE(error->column() == 15);
+
+        char const* const unnamed[] { nullptr };
+        error = subcommands.try_parse(unnamed, global);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == Kind::missing_subcommand);
+        REQUIRE(error->column() == 1);
+        REQUIRE_THROWS_AS(subcommands.parse(unnamed, global), cppargs::Exception);
+
+        char const* const unknown[] { "cppargstest", "-v", "test" };
+        error = subcommands.try_parse(unknown, global);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == Kind::unrecognized_subcommand);
+        REQUIRE(error->column() == 16);
+        REQUIRE(std::ranges::equal(error->choices(), std::array { "build"sv, "clean"sv }));
+        REQUIRE(subcommands.selected().empty());
+
+        char const* const option[] { "cppargstest", "clean", "-j1" };
+        error = subcommands.try_parse(option);
+        REQUIRE(error.has_value());
+        REQUIRE(error->kind() == Kind::unrecognized_option);
+        REQUIRE(error->column() == 20);
+        REQUIRE(subcommands.selected() == "clean");
+        REQUIRE(builds == 1);
+
+        char const* const misspelled[] { "cppargstest", "biuld" };
+        REQUIRE_THROWS_WITH(
+            subcommands.parse(misspelled),
+            "Unrecognized subcommand: 'biuld'; did you mean 'build'?");
+
+        char const* const long_option[] { "cppargstest", "build", "--jbos", "2" };
+        REQUIRE_THROWS_WITH(
+            subcommands.parse(long_option),
+            "Unrecognized option: 'jbos'; did you mean 'jobs'?");
+    }
+}
+
+TEST("parse observer")
+{
+    struct Recorder : cppargs::Parse_observer {
+        std::vector<cppargs::Token_event>   events;
+        std::optional<cppargs::Parse_stats> stats;
+
+        auto on_token(cppargs::Token_event const& event) -> void override
+        {
+            events.push_back(event);
+        }
+
+        auto on_finish(cppargs::Parse_stats const& totals) -> void override
+        {
+            stats = totals;
+        }
+    };
+
+    cppargs::Counting_resource resource;
+    cppargs::Parameters        parameters(&resource);
+    auto const                 ints = parameters.add<cppargs::Incremental<int>>('i', "int");
+    auto const                 flag = parameters.add('f', "flag");
+    Recorder                   recorder;
+
+    SECTION("events")
+    {
+        char const* const command_line[] { "cppargstest", "--int", "1", "-fi2" };
+        auto const        bytes_before = resource.bytes_allocated();
+        cppargs::parse(command_line, parameters, recorder);
+        REQUIRE(ints.values().size() == 2);
+        REQUIRE(flag);
+
+        REQUIRE(recorder.events.size() == 3);
+        REQUIRE(recorder.events[0].token == "--int");
+        REQUIRE(recorder.events[0].argument == 1);
+        REQUIRE(recorder.events[0].parameter == parameters.find("int"));
+        REQUIRE(recorder.events[0].lookups == 1);
+        REQUIRE(recorder.events[1].parameter == parameters.find("int"));
+        REQUIRE(recorder.events[1].lookups == 0);
+        REQUIRE(recorder.events[1].bytes_allocated != 0);
+        REQUIRE(recorder.events[2].lookups == 2);
+        REQUIRE_FALSE(recorder.events[2].error.has_value());
+
+        REQUIRE(recorder.stats.has_value());
+        REQUIRE(recorder.stats->tokens == 3);
+        REQUIRE(recorder.stats->lookups == 3);
+        REQUIRE(recorder.stats->conversions == 3);
+        REQUIRE(recorder.stats->errors == 0);
+        REQUIRE(recorder.stats->bytes_allocated == resource.bytes_allocated() - bytes_before);
+        REQUIRE(recorder.stats->total_time >= recorder.stats->conversion_time);
+    }
+    SECTION("error")
+    {
+        char const* const command_line[] { "cppargstest", "-f", "--int", "x", "-f" };
+        REQUIRE_THROWS_AS(cppargs::parse(command_line, parameters, recorder), cppargs::Exception);
+        REQUIRE(recorder.events.size() == 3);
+        REQUIRE(recorder.events[2].token == "x");
+        REQUIRE(recorder.events[2].error == cppargs::Parse_error_info::Kind::invalid_argument);
+        REQUIRE(recorder.stats->errors == 1);
+        REQUIRE(recorder.stats->exception_time.count() > 0);
+        REQUIRE(recorder.stats->total_time >= recorder.stats->exception_time);
+    }
+}
+
+TEST("collect all errors")
+{
+    using Kind = cppargs::Parse_error_info::Kind;
+
+    cppargs::Parameters  parameters;
+    auto const           ints = parameters.add<cppargs::Incremental<int>>('i', "int");
+    auto const           flag = parameters.add('f', "flag");
+    auto const           name = parameters.add<std::string>("name");
+    cppargs::Diagnostics diagnostics;
+
+    SECTION("command line")
+    {
+        char const* const command_line[] {
+            "cppargstest", "--int", "x", "-i2", "--bogus", "-fq", "-i3", "extra", "--name",
+        };
+        REQUIRE_FALSE(cppargs::parse_all(command_line, parameters, diagnostics));
+        REQUIRE(std::ranges::equal(ints.values(), std::vector { 2, 3 }));
+        REQUIRE(flag);
+        REQUIRE_FALSE(name.has_value());
+
+        auto const errors = diagnostics.errors();
+        REQUIRE(errors.size() == 5);
+        REQUIRE(errors[0].kind() == Kind::invalid_argument);
+        REQUIRE(errors[1].kind() == Kind::unrecognized_option);
+        REQUIRE(errors[2].kind() == Kind::unrecognized_option);
+        REQUIRE(errors[3].kind() == Kind::positional_argument);
+        REQUIRE(errors[4].kind() == Kind::missing_argument);
+        REQUIRE(
+            diagnostics.render()
+            == "cppargstest --int x -i2 --bogus -fq -i3 extra --name\n"
+               "                  ^ Invalid argument: 'x'\n"
+               "                          ^~~~~ Unrecognized option: 'bogus'\n"
+               "                                  ^ Unrecognized option: 'q'\n"
+               "                                        ^~~~~ Unexpected positional argument: "
+               "'extra'\n"
+               "                                                ^~~~ Missing argument for "
+               "parameter: 'name'\n");
+    }
+    SECTION("value of an unrecognized option")
+    {
+        char const* const command_line[] { "cppargstest", "--typo", "3", "--name", "x", "-z", "y" };
+        REQUIRE_FALSE(cppargs::parse_all(command_line, parameters, diagnostics));
+        REQUIRE(name.value() == "x");
+        REQUIRE(diagnostics.errors().size() == 2);
+        REQUIRE(diagnostics.errors()[0].view() == "typo");
+        REQUIRE(diagnostics.errors()[1].view() == "z");
+    }
+    SECTION("suggestions")
+    {
+        char const* const command_line[] { "cppargstest", "--nme", "x", "--flg", "-z" };
+        REQUIRE_FALSE(cppargs::parse_all(command_line, parameters, diagnostics));
+        REQUIRE(diagnostics.errors().size() == 3);
+        REQUIRE(std::ranges::equal(diagnostics.suggestions(0), std::vector { "name"sv }));
+        REQUIRE(std::ranges::equal(diagnostics.suggestions(1), std::vector { "flag"sv }));
+        REQUIRE(diagnostics.suggestions(2).empty());
+        REQUIRE(
+            diagnostics.render()
+            == "cppargstest --nme x --flg -z\n"
+               "              ^~~ Unrecognized option: 'nme'; did you mean 'name'?\n"
+               "                      ^~~ Unrecognized option: 'flg'; did you mean 'flag'?\n"
+               "                           ^ Unrecognized option: 'z'\n");
+
+        diagnostics.clear();
+        REQUIRE(diagnostics.empty());
+    }
+    SECTION("response file")
+    {
+        auto const path = write_temporary_file("cppargs-test-all.rsp", "-i1\n-i x\n-z -i y\n");
+        cppargs::Response_files files;
+        auto const              argument = "@" + path;
+        char const* const       command_line[] { "cppargstest", argument.c_str(), "-q" };
+        REQUIRE_FALSE(cppargs::parse_all(command_line, parameters, files, diagnostics));
+        REQUIRE(diagnostics.errors().size() == 4);
+        REQUIRE(
+            diagnostics.render()
+            == std::format(
+                "{0}:2:\n-i x\n   ^ Invalid argument: 'x'\n"
+                "{0}:3:\n-z -i y\n ^ Unrecognized option: 'z'\n"
+                "      ^ Invalid argument: 'y'\n"
+                "cppargstest {1} -q\n{2:{3}}^ Unrecognized option: 'q'\n",
+                path,
+                argument,
+                "",
+                argument.size() + 14));
+    }
+    SECTION("no errors")
+    {
+        char const* const command_line[] { "cppargstest", "-fi1" };
+        REQUIRE(cppargs::parse_all(command_line, parameters, diagnostics));
+        REQUIRE(diagnostics.empty());
+        REQUIRE(diagnostics.render().empty());
+    }
+}
+
+TEST("abbreviations and suggestions")
+{
+    using Kind = cppargs::Parse_error_info::Kind;
+    using Names = std::vector<std::string_view>;
+
+    cppargs::Parameters parameters;
+    auto const          verbose = parameters.add("verbose");
+    auto const          version = parameters.add("version");
+    auto const          color   = parameters.add<std::string>("color");
+    auto const          count   = parameters.add<int>('c', "count");
+
+    auto const error = [&](char const* const argument) {
+        char const* const command_line[] { "cppargstest", argument };
+        try {
+            cppargs::parse(command_line, parameters);
+        }
+        catch (cppargs::Exception const& exception) {
+            return exception;
+        }
+        throw std::logic_error { "Expected an exception" };
+    };
+
+    SECTION("suggestions")
+    {
+        REQUIRE(parameters.suggest("colr") == Names { "color" });
+        REQUIRE(parameters.suggest("versoin") == Names { "version", "verbose" });
+        REQUIRE(parameters.suggest("cout") == Names { "count" });
+        REQUIRE(parameters.suggest("verbose", 1) == Names { "verbose" });
+        REQUIRE(parameters.suggest("xyzzy").empty());
+        REQUIRE(parameters.suggest("").empty());
+
+        auto const exception = error("--verbos");
+        REQUIRE(exception.info().kind == Kind::unrecognized_option);
+        REQUIRE(exception.info().suggestions == std::vector<std::string> { "verbose", "version" });
+        REQUIRE(exception.what() == "Unrecognized option: 'verbos'; did you mean 'verbose'?"sv);
+
+        REQUIRE(error("--xyzzy").what() == "Unrecognized option: 'xyzzy'"sv);
+        REQUIRE(error("-x").info().suggestions.empty());
+    }
+    SECTION("suggestions without exceptions")
+    {
+        char const* const command_line[] { "cppargstest", "--verbos" };
+        auto const        error = cppargs::try_parse(command_line, parameters);
+        REQUIRE(error.has_value());
+        REQUIRE(error->suggestions(parameters) == Names { "verbose", "version" });
+        REQUIRE(error->info().suggestions.empty());
+        auto const info = error->info(parameters);
+        REQUIRE(info.suggestions == std::vector<std::string> { "verbose", "version" });
+
+        char const* const short_name[] { "cppargstest", "-x" };
+        REQUIRE(cppargs::try_parse(short_name, parameters)->suggestions(parameters).empty());
+    }
+    SECTION("abbreviations are not allowed by default")
+    {
+        REQUIRE(error("--verb").info().kind == Kind::unrecognized_option);
+    }
+    SECTION("abbreviations")
+    {
+        parameters.allow_abbreviations();
+        char const* const command_line[] { "cppargstest", "--verb", "--col", "red", "--cou", "5" };
+        cppargs::parse(command_line, parameters);
+        REQUIRE(verbose);
+        REQUIRE_FALSE(version);
+        REQUIRE(color.value() == "red");
+        REQUIRE(count.value() == 5);
+
+        REQUIRE(parameters.match("version") == parameters.find("version"));
+        REQUIRE(parameters.match("vers") == parameters.find("version"));
+        REQUIRE(parameters.match("ver") == nullptr);
+        REQUIRE(parameters.match("verbosely") == nullptr);
+
+        auto const exception = error("--ver");
+        REQUIRE(exception.info().suggestions == std::vector<std::string> { "verbose", "version" });
+        REQUIRE(parameters.suggest("co") == Names { "color", "count" });
+    }
+}
+
+namespace {
+    enum class Shape { circle, square, star };
+} // namespace
+
+template <>
+struct cppargs::Argument<Shape> {
+    static auto parse(std::string_view const view) -> std::optional<Shape>
+    {
+        if (view == "circle") return Shape::circle;
+        if (view == "square") return Shape::square;
+        if (view == "star") return Shape::star;
+        return std::nullopt;
+    }
+
+    static auto complete(std::string_view) -> std::vector<std::string>
+    {
+        return { "circle", "square", "star" };
+    }
+};
+
+TEST("completion")
+{
+    using Words = std::vector<std::string>;
+
+    cppargs::Parameters parameters;
+    auto const          verbose = parameters.add('v', "verbose");
+    auto const          version = parameters.add("version");
+    auto const          shape   = parameters.add<Shape>('s', "shape");
+    auto const          debug   = parameters.add<bool>("debug");
+    auto const          count   = parameters.add<int>('c', "count");
+    auto const          shapes  = parameters.add_positional<cppargs::Incremental<Shape>>("shapes");
+
+    auto const complete = [&](std::vector<char const*> command_line) {
+        command_line.insert(command_line.begin(), "cppargstest");
+        return cppargs::complete(command_line, command_line.size() - 1, parameters);
+    };
+
+    SECTION("options")
+    {
+        REQUIRE(complete({ "--ver" }) == Words { "--verbose", "--version" });
+        REQUIRE(complete({ "--sh" }) == Words { "--shape" });
+        REQUIRE(complete({ "--x" }).empty());
+        REQUIRE(
+            complete({ "-" })
+            == Words {
+                "--count", "--debug", "--shape", "--verbose", "--version", "-v", "-s", "-c",
+            });
+        REQUIRE(complete({ "-vs" }).empty());
+    }
+    SECTION("values")
+    {
+        REQUIRE(complete({ "--shape", "s" }) == Words { "square", "star" });
+        REQUIRE(complete({ "-vs", "" }) == Words { "circle", "square", "star" });
+        REQUIRE(complete({ "--debug", "o" }) == Words { "on", "off" });
+        REQUIRE(complete({ "--count", "" }).empty());
+        REQUIRE(complete({ "-c1", "c" }) == Words { "circle" });
+        REQUIRE(complete({ "circle", "--", "-" }) == Words {});
+        REQUIRE(complete({ "--", "st" }) == Words { "star" });
+
+        char const* const command_line[] { "cppargstest", "--shape" };
+        REQUIRE(cppargs::complete(command_line, 2, parameters).size() == 3);
+        REQUIRE(cppargs::complete(command_line, 3, parameters).empty());
+    }
+    SECTION("answering queries")
+    {
+        char const* const command_line[] { "cppargstest", "--shape", "c" };
+        char const* const query[] { "HOME=/", "CPPARGS_COMPLETE=2" };
+        char const* const no_query[] { "HOME=/" };
+
+        std::FILE* const file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        REQUIRE_FALSE(cppargs::answer_completion(command_line, parameters, file, no_query));
+        REQUIRE(cppargs::answer_completion(command_line, parameters, file, query));
+
+        std::rewind(file);
+        std::array<char, 64> buffer {};
+        auto const size = std::fread(buffer.data(), 1, buffer.size(), file);
+        REQUIRE(std::string_view(buffer.data(), size) == "circle\n");
+        std::fclose(file);
+    }
+    SECTION("scripts")
+    {
+        auto const contains = [](std::string_view const script, std::string_view const part) {
+            return script.find(part) != std::string_view::npos;
+        };
+        auto const bash = cppargs::completion_script(cppargs::Shell::bash, "my-tool", parameters);
+        REQUIRE(contains(bash, "-W '--count --debug --shape --verbose --version -v -s -c'"));
+        REQUIRE(contains(bash, "complete -o default -F _cppargs_my_tool 'my-tool'\n"));
+
+        auto const zsh = cppargs::completion_script(cppargs::Shell::zsh, "my-tool", parameters);
+        REQUIRE(zsh.starts_with("#compdef my-tool\n"));
+        REQUIRE(contains(zsh, "candidates=('--count' '--debug'"));
+
+        auto const fish = cppargs::completion_script(cppargs::Shell::fish, "my-tool", parameters);
+        REQUIRE(contains(fish, "complete -c 'my-tool' -s 's' -l 'shape' -r\n"));
+        REQUIRE(contains(fish, "complete -c 'my-tool' -l 'version'\n"));
+    }
+    REQUIRE_FALSE(verbose);
+    REQUIRE_FALSE(version);
+    REQUIRE_FALSE(shape);
+    REQUIRE_FALSE(debug);
+    REQUIRE_FALSE(count);
+    REQUIRE_FALSE(shapes);
+}
+
+namespace {
+    enum class Level { debug, info, warning, error };
+
+    constexpr auto level_names = cppargs::enum_names<Level>(
+        "level",
+        {
+            { "debug", Level::debug },
+            { "info", Level::info },
+            { "warning", Level::warning },
+            { "error", Level::error },
+        },
+        cppargs::Case::insensitive);
+} // namespace
+
+template <>
+struct cppargs::Argument<Level> : cppargs::Enum_argument<level_names> {};
+
+TEST("enum arguments")
+{
+    using Names = std::vector<std::string>;
+
+    cppargs::Parameters parameters;
+    auto const          level  = parameters.add<Level>('l', "level", "Log level");
+    auto const          levels = parameters.add_positional<cppargs::Incremental<Level>>("levels");
+
+    auto const parse = [&](std::vector<char const*> command_line) {
+        command_line.insert(command_line.begin(), "cppargstest");
+        return cppargs::try_parse(command_line, parameters);
+    };
+
+    SECTION("parsing")
+    {
+        REQUIRE_FALSE(parse({ "--level", "Warning", "debug", "ERROR" }).has_value());
+        REQUIRE(level.value() == Level::warning);
+        REQUIRE(std::ranges::equal(levels.values(), std::array { Level::debug, Level::error }));
+        REQUIRE(cppargs::Argument<Level>::parse("inf") == std::nullopt);
+        REQUIRE(cppargs::Argument<Level>::parse("") == std::nullopt);
+        REQUIRE(cppargs::Parse_cache::is_eligible(parameters));
+    }
+    SECTION("errors")
+    {
+        char const* const misspelled_line[] { "cppargstest", "-lwarnin" };
+        auto const        error = cppargs::try_parse(misspelled_line, parameters);
+        REQUIRE(error.has_value());
+        REQUIRE(error->choices().size() == 4);
+
+        cppargs::Exception const misspelled(error.value());
+        REQUIRE(misspelled.info().suggestions == Names { "warning" });
+        REQUIRE(misspelled.info().choices == Names { "debug", "info", "warning", "error" });
+        REQUIRE(misspelled.what() == "Invalid argument: 'warnin'; did you mean 'warning'?"sv);
+
+        char const* const        unknown_line[] { "cppargstest", "verbose" };
+        cppargs::Exception const unknown(cppargs::try_parse(unknown_line, parameters).value());
+        REQUIRE(unknown.info().suggestions.empty());
+        REQUIRE(
+            unknown.what()
+            == "Invalid argument: 'verbose'; expected one of: debug, info, warning, error"sv);
+    }
+    SECTION("help and completion")
+    {
+        REQUIRE(
+            parameters.help_string()
+            == "\t--level, -l [level] : Log level\n"
+               "\t                      One of: debug, info, warning, error\n"
+               "\t<levels>...         : ...\n"
+               "\t                      One of: debug, info, warning, error\n");
+
+        char const* const command_line[] { "cppargstest", "--level", "" };
+        REQUIRE(cppargs::complete(command_line, 2, parameters).size() == 4);
+        REQUIRE(cppargs::Argument<Level>::complete("WA") == Names { "warning" });
+        REQUIRE(cppargs::Argument<Level>::complete("in") == Names { "info" });
+        REQUIRE(cppargs::Argument<Level>::complete("x").empty());
+    }
+}
+
+TEST("parse cache")
+{
+    auto const directory = std::filesystem::temp_directory_path() / "cppargs-test-cache";
+    std::filesystem::remove_all(directory);
+
+    auto const        path     = write_temporary_file("cppargs-test-cache.rsp", "--name hi -i2");
+    auto const        argument = "@" + path;
+    char const* const command_line[] { "cppargstest", "-vi1", argument.c_str(), "in", "--", "a" };
+
+    auto const parse = [&](cppargs::Parse_cache& cache, std::string_view const expected_name) {
+        cppargs::Parameters     parameters;
+        auto const              verbose  = parameters.add('v', "verbose");
+        auto const              ints     = parameters.add<cppargs::Incremental<int>>('i', "int");
+        auto const              name     = parameters.add<std::string>('n', "name");
+        auto const              input    = parameters.add_positional<std::string_view>("input");
+        auto const              trailing = parameters.add_trailing("command");
+        cppargs::Response_files files;
+        REQUIRE(cppargs::Parse_cache::is_eligible(parameters));
+        cppargs::parse(command_line, parameters, files, cache);
+        REQUIRE(verbose.has_value());
+        REQUIRE(std::ranges::equal(ints.values(), std::array { 1, 2 }));
+        REQUIRE(name.value() == expected_name);
+        REQUIRE(input.value() == "in");
+        REQUIRE(trailing.arguments().size() == 1);
+        REQUIRE(trailing.arguments().front() == command_line[5]);
+    };
+
+    SECTION("restore")
+    {
+        cppargs::Parse_cache cache(directory.string());
+        parse(cache, "hi");
+        REQUIRE(cache.hits() == 0);
+        REQUIRE(cache.misses() == 1);
+        parse(cache, "hi");
+        REQUIRE(cache.hits() == 1);
+
+        cppargs::Parse_cache other(directory.string());
+        parse(other, "hi");
+        REQUIRE(other.hits() == 1);
+    }
+    SECTION("changed response file")
+    {
+        cppargs::Parse_cache cache(directory.string());
+        parse(cache, "hi");
+        write_temporary_file("cppargs-test-cache.rsp", "--name hello -i2");
+        parse(cache, "hello");
+        REQUIRE(cache.hits() == 0);
+        parse(cache, "hello");
+        REQUIRE(cache.hits() == 1);
+    }
+    SECTION("changed version")
+    {
+        cppargs::Parse_cache cache(directory.string(), "1");
+        parse(cache, "hi");
+        cppargs::Parse_cache other(directory.string(), "2");
+        parse(other, "hi");
+        REQUIRE(other.hits() == 0);
+    }
+    SECTION("changed parameters")
+    {
+        cppargs::Parse_cache cache(directory.string());
+        parse(cache, "hi");
+
+        using Unsigned = cppargs::Incremental<unsigned>;
+        cppargs::Parameters     parameters;
+        auto const              verbose = parameters.add('v', "verbose");
+        auto const              ints    = parameters.add<Unsigned>('i', "int");
+        auto const              name    = parameters.add<std::string>('n', "name");
+        auto const              input   = parameters.add_positional<std::string_view>("input");
+        auto const              command = parameters.add_trailing("command");
+        cppargs::Response_files files;
+        cppargs::parse(command_line, parameters, files, cache);
+        REQUIRE(cache.hits() == 0);
+        REQUIRE(std::ranges::equal(ints.values(), std::array { 1U, 2U }));
+        REQUIRE(verbose);
+        REQUIRE(name);
+        REQUIRE(input);
+        REQUIRE(command);
+    }
+    SECTION("corrupt snapshot")
+    {
+        cppargs::Parse_cache cache(directory.string());
+        parse(cache, "hi");
+        for (auto const& entry : std::filesystem::directory_iterator(directory)) {
+            auto const size = std::filesystem::file_size(entry.path());
+            std::fstream(entry.path(), std::ios::binary | std::ios::in | std::ios::out)
+                .seekp(static_cast<std::streamoff>(size - 12))
+                .put('\xff');
+        }
+        cppargs::Parse_cache corrupt(directory.string());
+        parse(corrupt, "hi");
+        REQUIRE(corrupt.hits() == 0);
+
+        for (auto const& entry : std::filesystem::directory_iterator(directory)) {
+            auto const size = std::filesystem::file_size(entry.path());
+            std::filesystem::resize_file(entry.path(), size / 2);
+        }
+        cppargs::Parse_cache truncated(directory.string());
+        parse(truncated, "hi");
+        REQUIRE(truncated.hits() == 0);
+    }
+    SECTION("errors are not stored")
+    {
+        cppargs::Parse_cache    cache(directory.string());
+        cppargs::Parameters     parameters;
+        auto const              ints = parameters.add<cppargs::Incremental<int>>('i', "int");
+        char const* const       invalid[] { "cppargstest", "-i1", "-ix" };
+        cppargs::Response_files files;
+        for (int run = 0; run != 2; ++run) {
+            REQUIRE(cppargs::try_parse(invalid, parameters, files, cache).has_value());
+        }
+        REQUIRE(cache.misses() == 2);
+        REQUIRE(ints.values().size() == 2);
+    }
+    SECTION("parameters that cannot be stored")
+    {
+        cppargs::Parse_cache    cache(directory.string());
+        cppargs::Parameters     parameters;
+        auto const              shape = parameters.add<Shape>('s', "shape");
+        char const* const       arguments[] { "cppargstest", "-s", "circle" };
+        cppargs::Response_files files;
+        REQUIRE_FALSE(cppargs::Parse_cache::is_eligible(parameters));
+        cppargs::parse(arguments, parameters, files, cache);
+        cppargs::parse(arguments, parameters, files, cache);
+        REQUIRE(shape.value() == Shape::circle);
+        REQUIRE(cache.hits() == 0);
+        REQUIRE(cache.misses() == 2);
+    }
+    std::filesystem::remove_all(directory);
+}